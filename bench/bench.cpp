@@ -0,0 +1,679 @@
+// Headless playback throughput benchmark.
+//
+// Plays locally generated synthetic clips through MpvWidget under the Qt
+// offscreen platform and writes a JSON report (fps, frame-time percentiles,
+// dropped frames, CPU time, peak RSS). Clips are encoded with ffmpeg from
+// lavfi test sources when it is installed, otherwise the raw lavfi source is
+// played directly.
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalSocket>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+#include <sys/resource.h>
+#include <unistd.h>
+#include "controlserver.h"
+#include "mpvwidget.h"
+#include "throttledhttpserver.h"
+#include "videowall.h"
+
+struct BenchClip
+{
+    QString codec;
+    int width = 0;
+    int height = 0;
+    int fps = 0;
+    QString url;
+    QString error;
+
+    QString name() const { return QString("%1_%2p%3").arg(codec).arg(height).arg(fps); }
+};
+
+struct EncoderArgs
+{
+    const char *codec;
+    const char *container;
+    QStringList args;
+};
+
+static const QList<EncoderArgs> &encoders()
+{
+    static const QList<EncoderArgs> list = {
+        {"h264", "mkv", {"-c:v", "libx264", "-preset", "ultrafast", "-pix_fmt", "yuv420p"}},
+        {"hevc", "mkv", {"-c:v", "libx265", "-preset", "ultrafast", "-pix_fmt", "yuv420p"}},
+        {"vp9", "webm", {"-c:v", "libvpx-vp9", "-deadline", "realtime", "-cpu-used", "8", "-row-mt", "1"}},
+        {"av1", "mkv", {"-c:v", "libsvtav1", "-preset", "12", "-pix_fmt", "yuv420p"}},
+    };
+    return list;
+}
+
+static QString lavfiSource(const BenchClip &clip, int seconds)
+{
+    return QString("testsrc2=size=%1x%2:rate=%3:duration=%4")
+        .arg(clip.width).arg(clip.height).arg(clip.fps).arg(seconds);
+}
+
+static void prepareClip(BenchClip &clip, const QString &ffmpeg, const QDir &dir, int seconds)
+{
+    // Raw lavfi input: no codec work, but still exercises render and upload
+    if (ffmpeg.isEmpty() || clip.codec == "raw") {
+        clip.codec = "raw";
+        clip.url = "av://lavfi:" + lavfiSource(clip, seconds);
+        return;
+    }
+
+    const EncoderArgs *enc = nullptr;
+    for (const EncoderArgs &e : encoders()) {
+        if (clip.codec == e.codec)
+            enc = &e;
+    }
+    if (!enc) {
+        clip.error = "unknown codec";
+        return;
+    }
+
+    const QString path = dir.filePath(QString("%1_%2s.%3").arg(clip.name()).arg(seconds).arg(enc->container));
+    if (QFileInfo::exists(path)) {
+        clip.url = path;
+        return;
+    }
+
+    QStringList args = {"-y", "-hide_banner", "-loglevel", "error",
+                        "-f", "lavfi", "-i", lavfiSource(clip, seconds)};
+    args << enc->args << path;
+
+    QProcess proc;
+    proc.start(ffmpeg, args);
+    if (!proc.waitForFinished(-1) || proc.exitCode() != 0) {
+        clip.error = QString::fromUtf8(proc.readAllStandardError()).trimmed();
+        if (clip.error.isEmpty())
+            clip.error = "ffmpeg failed";
+        QFile::remove(path);
+        return;
+    }
+    clip.url = path;
+}
+
+static double cpuSeconds()
+{
+    rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec
+         + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+static qint64 peakRssKb()
+{
+    rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// Resident set right now; peak RSS never goes down between runs
+static qint64 currentRssKb()
+{
+    QFile statm("/proc/self/statm");
+    if (!statm.open(QIODevice::ReadOnly))
+        return 0;
+    const QList<QByteArray> fields = statm.readAll().split(' ');
+    return fields.value(1).toLongLong() * sysconf(_SC_PAGESIZE) / 1024;
+}
+
+static QJsonObject percentiles(const FrameTimeRing &ring)
+{
+    return QJsonObject{
+        {"p50", ring.percentile(0.50) / 1000.0},
+        {"p95", ring.percentile(0.95) / 1000.0},
+        {"p99", ring.percentile(0.99) / 1000.0},
+    };
+}
+
+static QJsonObject runClip(MpvWidget *player, const BenchClip &clip, int seconds)
+{
+    QJsonObject result{
+        {"name", clip.name()},
+        {"codec", clip.codec},
+        {"width", clip.width},
+        {"height", clip.height},
+        {"fps", clip.fps},
+        {"duration_s", seconds},
+    };
+
+    if (!clip.error.isEmpty()) {
+        result["error"] = clip.error;
+        return result;
+    }
+
+    // mpv resets its counters per file, so keep the last values seen while playing
+    qint64 voDrops = 0, decoderDrops = 0, delayed = 0, mistimed = 0;
+    QTimer sampler;
+    sampler.setInterval(100);
+    QObject::connect(&sampler, &QTimer::timeout, [&]() {
+        mpv_handle *mpv = player->handle();
+        int64_t v = 0;
+        if (mpv_get_property(mpv, "frame-drop-count", MPV_FORMAT_INT64, &v) >= 0)
+            voDrops = v;
+        if (mpv_get_property(mpv, "decoder-frame-drop-count", MPV_FORMAT_INT64, &v) >= 0)
+            decoderDrops = v;
+        if (mpv_get_property(mpv, "vo-delayed-frame-count", MPV_FORMAT_INT64, &v) >= 0)
+            delayed = v;
+        if (mpv_get_property(mpv, "mistimed-frame-count", MPV_FORMAT_INT64, &v) >= 0)
+            mistimed = v;
+    });
+
+    QEventLoop loop;
+    bool failed = false;
+    bool timedOut = false;
+    QObject::connect(player, &MpvWidget::playbackEnded, &loop, [&](bool error) {
+        failed = error;
+        loop.quit();
+    });
+    QTimer::singleShot((seconds * 10 + 30) * 1000, &loop, [&]() {
+        timedOut = true;
+        loop.quit();
+    });
+
+    player->setFrameStatsEnabled(true);
+    const double cpuStart = cpuSeconds();
+    QElapsedTimer wall;
+    wall.start();
+
+    sampler.start();
+    player->play(clip.url);
+    loop.exec();
+    sampler.stop();
+
+    const double wallSeconds = wall.nsecsElapsed() / 1e9;
+    const double cpu = cpuSeconds() - cpuStart;
+    const FrameStats &stats = player->frameTimings();
+    player->setFrameStatsEnabled(false);
+
+    if (failed)
+        result["error"] = "playback failed";
+    else if (timedOut)
+        result["error"] = "timed out";
+
+    result["wall_s"] = wallSeconds;
+    result["frames"] = static_cast<qint64>(stats.framesRendered);
+    result["fps_achieved"] = wallSeconds > 0 ? stats.framesRendered / wallSeconds : 0.0;
+    result["render_ms"] = percentiles(stats.renderTime);
+    result["frame_interval_ms"] = percentiles(stats.frameInterval);
+    result["dropped"] = QJsonObject{
+        {"vo", voDrops},
+        {"decoder", decoderDrops},
+        {"delayed", delayed},
+        {"mistimed", mistimed},
+    };
+    const MpvWidget::StreamStats stream = player->streamStats();
+    result["cache"] = QJsonObject{
+        {"profile", stream.profile},
+        {"stalls", stream.stalls},
+        {"rebuffer_s", stream.rebufferMs / 1000.0},
+        {"input_kbps", player->playerState().cacheInputRate * 8 / 1000},
+    };
+    result["cpu_s"] = cpu;
+    result["cpu_utilization"] = wallSeconds > 0 ? cpu / wallSeconds : 0.0;
+    result["peak_rss_kb"] = peakRssKb();
+
+    const DecodeConfig &decode = player->decoderConfig();
+    result["decode"] = QJsonObject{
+        {"config", decode.describe()},
+        {"threads", decode.threads},
+        {"slice_threads", decode.sliceThreads},
+        {"fast", decode.fast},
+        {"skip_loop_filter", decode.skipLoopFilter},
+        {"level", decode.level},
+    };
+    qInfo().noquote() << QString("bench: %1 decoded with %2: %3 fps, %4 decoder drops")
+                             .arg(clip.name(), decode.describe())
+                             .arg(result["fps_achieved"].toDouble(), 0, 'f', 1)
+                             .arg(decoderDrops);
+    return result;
+}
+
+// Load a clip paused and measure what the player does while sitting on it
+static QJsonObject runIdle(MpvWidget *player, const BenchClip &clip, int seconds)
+{
+    QJsonObject result{{"clip", clip.name()}, {"seconds", seconds}};
+
+    player->play(clip.url);
+    mpv_set_property_string(player->handle(), "pause", "yes");
+
+    // Let the file open and the first frame settle before counting
+    QEventLoop settle;
+    QTimer::singleShot(1000, &settle, &QEventLoop::quit);
+    settle.exec();
+
+    if (player->powerState() != MpvWidget::PowerState::Paused) {
+        result["error"] = "player did not go idle";
+        return result;
+    }
+
+    const MpvWidget::IdleStats before = player->idleStats();
+    const double cpuStart = cpuSeconds();
+
+    QEventLoop loop;
+    QTimer::singleShot(seconds * 1000, &loop, &QEventLoop::quit);
+    loop.exec();
+
+    const MpvWidget::IdleStats after = player->idleStats();
+    const double cpu = cpuSeconds() - cpuStart;
+
+    // The bench's own timer wakes the GUI loop once
+    result["gui_wakeups"] = static_cast<qint64>(after.guiWakeups - before.guiWakeups);
+    result["mpv_events"] = static_cast<qint64>(after.mpvEvents - before.mpvEvents);
+    result["cpu_s"] = cpu;
+    result["gui_wakeups_per_s"] = (after.guiWakeups - before.guiWakeups) / double(seconds);
+    return result;
+}
+
+// Separate players get this long to start before their cost is sampled
+static constexpr int kSeparateWarmupMs = 3000;
+
+// Play one clip in every tile of a wall for a while and measure what it costs
+static QJsonObject runWall(const BenchClip &clip, int tileCount, int seconds, const QSize &size)
+{
+    QJsonObject result{{"clip", clip.name()}, {"tiles", tileCount}, {"seconds", seconds}};
+
+    const qint64 rssBefore = currentRssKb();
+    VideoWall wall;
+    wall.resize(size);
+    wall.show();
+
+    QEventLoop ready;
+    QObject::connect(&wall, &VideoWall::ready, &ready, &QEventLoop::quit);
+    QTimer::singleShot(10000, &ready, &QEventLoop::quit);
+    wall.setSources(QStringList(tileCount, clip.url));
+    ready.exec();
+
+    const double cpuStart = cpuSeconds();
+    QEventLoop loop;
+    QTimer::singleShot(seconds * 1000, &loop, &QEventLoop::quit);
+    loop.exec();
+    const double cpu = cpuSeconds() - cpuStart;
+
+    QJsonArray tiles;
+    int playing = 0;
+    for (const VideoWall::TileStats &tile : wall.tileStats()) {
+        playing += tile.playing;
+        tiles.append(QJsonObject{
+            {"playing", tile.playing},
+            {"decode_threads", tile.decodeThreads},
+            {"fps_achieved", tile.framesRendered / double(seconds)},
+        });
+    }
+
+    result["playing"] = playing;
+    result["cpu_s"] = cpu;
+    result["cpu_utilization"] = cpu / seconds;
+    result["rss_kb"] = currentRssKb() - rssBefore;
+    // Whole process, Qt and GL setup included, like a separate player's
+    result["rss_total_kb"] = currentRssKb();
+    result["tile_results"] = tiles;
+    return result;
+}
+
+// CPU seconds (user + system) and resident KiB of another process; false once it is gone
+static bool processUsage(qint64 pid, double *cpu, qint64 *rssKb)
+{
+    QFile stat(QString("/proc/%1/stat").arg(pid));
+    QFile statm(QString("/proc/%1/statm").arg(pid));
+    if (!stat.open(QIODevice::ReadOnly) || !statm.open(QIODevice::ReadOnly))
+        return false;
+
+    // Fields after the parenthesised command name, which may contain spaces
+    const QByteArray line = stat.readAll();
+    const QList<QByteArray> fields = line.mid(line.lastIndexOf(')') + 2).split(' ');
+    const double ticks = sysconf(_SC_CLK_TCK);
+    *cpu = (fields.value(11).toLongLong() + fields.value(12).toLongLong()) / ticks;
+    *rssKb = statm.readAll().split(' ').value(1).toLongLong() * sysconf(_SC_PAGESIZE) / 1024;
+    return true;
+}
+
+// The same clip in that many single-stream player processes, each a
+// one-tile wall so only the per-process cost differs from the shared wall
+static QJsonObject runSeparatePlayers(const QString &player, const BenchClip &clip, int count, int seconds)
+{
+    QJsonObject result{{"processes", count}};
+
+    QList<QProcess *> processes;
+    for (int i = 0; i < count; ++i) {
+        auto *process = new QProcess;
+        process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+        process->start(player, {"--wall", clip.url});
+        processes << process;
+    }
+
+    // Startup is not measured, like the wall's wait for ready
+    QEventLoop warmup;
+    QTimer::singleShot(kSeparateWarmupMs, &warmup, &QEventLoop::quit);
+    warmup.exec();
+
+    QList<double> cpuStart;
+    for (QProcess *process : std::as_const(processes)) {
+        double cpu = 0;
+        qint64 rss = 0;
+        cpuStart << (processUsage(process->processId(), &cpu, &rss) ? cpu : -1);
+    }
+
+    QEventLoop loop;
+    QTimer::singleShot(seconds * 1000, &loop, &QEventLoop::quit);
+    loop.exec();
+
+    int running = 0;
+    double cpuTotal = 0;
+    qint64 rssTotal = 0;
+    for (int i = 0; i < processes.size(); ++i) {
+        double cpu = 0;
+        qint64 rss = 0;
+        if (cpuStart[i] >= 0 && processUsage(processes[i]->processId(), &cpu, &rss)) {
+            ++running;
+            cpuTotal += cpu - cpuStart[i];
+            rssTotal += rss;
+        }
+    }
+
+    for (QProcess *process : std::as_const(processes)) {
+        process->terminate();
+        if (!process->waitForFinished(2000))
+            process->kill();
+        process->waitForFinished(2000);
+        delete process;
+    }
+
+    result["running"] = running;
+    result["cpu_s"] = cpuTotal;
+    result["rss_kb"] = rssTotal;
+    return result;
+}
+
+// Round trips through the control socket: single commands and one batched write
+static QJsonObject runControlLatency(MpvWidget *player, int count)
+{
+    static constexpr int kBatchSize = 100;
+    QJsonObject result{{"round_trips", count}, {"batch_size", kBatchSize}};
+
+    ControlServer server(player);
+    if (!server.listen(QString("mpv_player_bench_%1").arg(QCoreApplication::applicationPid()))) {
+        result["error"] = "cannot listen";
+        return result;
+    }
+
+    QLocalSocket socket;
+    socket.connectToServer(server.serverPath());
+    QEventLoop connectLoop;
+    QObject::connect(&socket, &QLocalSocket::connected, &connectLoop, &QEventLoop::quit);
+    QTimer::singleShot(5000, &connectLoop, &QEventLoop::quit);
+    if (socket.state() != QLocalSocket::ConnectedState)
+        connectLoop.exec();
+    if (socket.state() != QLocalSocket::ConnectedState) {
+        result["error"] = "cannot connect";
+        return result;
+    }
+
+    // Server and client share this thread, so replies are waited for in the event loop
+    QElapsedTimer clock;
+    auto roundTrip = [&](const QByteArray &payload, int replies) -> qint64 {
+        int received = 0;
+        QEventLoop loop;
+        QMetaObject::Connection c = QObject::connect(&socket, &QLocalSocket::readyRead, &loop, [&]() {
+            received += socket.readAll().count('\n');
+            if (received >= replies)
+                loop.quit();
+        });
+        QTimer::singleShot(5000, &loop, &QEventLoop::quit);
+        clock.start();
+        socket.write(payload);
+        loop.exec();
+        QObject::disconnect(c);
+        return received >= replies ? clock.nsecsElapsed() / 1000 : -1;
+    };
+
+    auto measure = [&](const QByteArray &line) {
+        FrameTimeRing ring;
+        for (int i = 0; i < count; ++i) {
+            const qint64 us = roundTrip(line, 1);
+            if (us < 0)
+                return QJsonObject{{"error", "timed out"}};
+            ring.add(us);
+        }
+        return QJsonObject{
+            {"p50_us", ring.percentile(0.50)},
+            {"p95_us", ring.percentile(0.95)},
+            {"p99_us", ring.percentile(0.99)},
+        };
+    };
+
+    result["ping"] = measure("ping\n");
+    result["state"] = measure("{\"id\": 1, \"command\": \"state\"}\n");
+
+    const qint64 batchUs = roundTrip(QByteArray("state\n").repeated(kBatchSize), kBatchSize);
+    result["batch_us"] = batchUs;
+    result["batch_per_command_us"] = batchUs >= 0 ? batchUs / double(kBatchSize) : -1.0;
+    return result;
+}
+
+static QList<int> parseInts(const QString &list)
+{
+    QList<int> out;
+    for (const QString &part : list.split(',', Qt::SkipEmptyParts))
+        out << part.trimmed().toInt();
+    return out;
+}
+
+int main(int argc, char *argv[])
+{
+    // Must run on a plain box without a display or GPU
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+    QApplication::setApplicationName("mpv_player_bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless playback throughput benchmark");
+    parser.addHelpOption();
+    QCommandLineOption realtimeOpt("realtime", "Play at normal speed instead of as fast as possible.");
+    QCommandLineOption codecsOpt("codecs", "Comma separated codecs (h264,hevc,vp9,av1,raw).", "list", "h264,hevc,vp9");
+    QCommandLineOption heightsOpt("heights", "Comma separated clip heights (16:9).", "list", "1080,2160");
+    QCommandLineOption ratesOpt("rates", "Comma separated frame rates.", "list", "30,60");
+    QCommandLineOption secondsOpt("seconds", "Length of each clip.", "seconds", "5");
+    QCommandLineOption clipDirOpt("clip-dir", "Keep generated clips in this directory.", "dir");
+    QCommandLineOption sizeOpt("window", "Render size (WxH).", "size", "1920x1080");
+    QCommandLineOption modesOpt("render-modes", "Comma separated render modes to compare (composited,direct,software).", "list", "composited,direct");
+    QCommandLineOption httpOpt("http-kbps", "Serve encoded clips over local HTTP throttled to this rate.", "kbit/s");
+    QCommandLineOption idleOpt("idle-seconds", "Also measure wakeups and CPU while paused for this long.", "seconds", "0");
+    QCommandLineOption wallOpt("wall-tiles", "Comma separated tile counts to play the first clip in a video wall.", "list");
+    QCommandLineOption playerOpt("player", "Player executable for the separate-process wall comparison.", "path",
+                                 QCoreApplication::applicationDirPath() + "/mpv_player");
+    QCommandLineOption controlOpt("control-round-trips", "Also time this many control socket round trips per mode.", "count", "0");
+    QCommandLineOption decodeTuningOpt("decode-tuning", "Per-file decoder tuning: on, off or both (each clip twice).", "mode", "on");
+    QCommandLineOption pinControlsOpt("pin-controls", "Keep the control bar visible to measure its cost.");
+    QCommandLineOption outOpt({"o", "output"}, "Write the JSON report here instead of stdout.", "file");
+    parser.addOptions({realtimeOpt, codecsOpt, heightsOpt, ratesOpt, secondsOpt, clipDirOpt, sizeOpt, modesOpt, httpOpt, idleOpt, wallOpt, playerOpt, controlOpt, decodeTuningOpt, pinControlsOpt, outOpt});
+    parser.process(app);
+
+    const bool realtime = parser.isSet(realtimeOpt);
+    const int seconds = qMax(1, parser.value(secondsOpt).toInt());
+
+    QTemporaryDir tempDir;
+    QDir clipDir(parser.isSet(clipDirOpt) ? parser.value(clipDirOpt) : tempDir.path());
+    clipDir.mkpath(".");
+
+    const QString ffmpeg = QStandardPaths::findExecutable("ffmpeg");
+    if (ffmpeg.isEmpty())
+        qWarning() << "ffmpeg not found; benchmarking raw lavfi sources only";
+
+    QList<BenchClip> clips;
+    const QStringList codecs = parser.value(codecsOpt).split(',', Qt::SkipEmptyParts);
+    for (int height : parseInts(parser.value(heightsOpt))) {
+        for (int fps : parseInts(parser.value(ratesOpt))) {
+            for (const QString &codec : codecs) {
+                BenchClip clip;
+                clip.codec = codec.trimmed();
+                clip.height = height;
+                clip.width = (height * 16 / 9) & ~1;
+                clip.fps = fps;
+                prepareClip(clip, ffmpeg, clipDir, seconds);
+                clips << clip;
+            }
+        }
+    }
+
+    // Simulated network: files go through a rate-limited local HTTP server
+    ThrottledHttpServer httpServer(parser.value(httpOpt).toLongLong() * 1000 / 8);
+    if (parser.isSet(httpOpt)) {
+        if (!httpServer.listen())
+            return 1;
+        for (BenchClip &clip : clips) {
+            if (clip.error.isEmpty() && QFileInfo::exists(clip.url))
+                clip.url = httpServer.publish(clip.url);
+        }
+    }
+
+    QList<VideoBackend::Mode> modes;
+    for (const QString &name : parser.value(modesOpt).split(',', Qt::SkipEmptyParts)) {
+        VideoBackend::Mode mode;
+        if (!VideoBackend::parseMode(name.trimmed(), &mode)) {
+            qCritical() << "Unknown render mode" << name;
+            return 1;
+        }
+        modes << mode;
+    }
+
+    // Each mode gets a fresh player so surfaces and GL state do not carry over
+    const QStringList size = parser.value(sizeOpt).split('x');
+    QJsonArray modeResults;
+    for (VideoBackend::Mode mode : std::as_const(modes)) {
+        MpvWidget player(nullptr, mode);
+        player.setAutoAdvance(false);
+        player.setMpvOption("audio", "no");
+        player.setMpvOption("keep-open", "no");
+        if (!realtime) {
+            player.setMpvOption("untimed", "yes");
+            player.setMpvOption("video-sync", "desync");
+        }
+        player.setControlsPinned(parser.isSet(pinControlsOpt));
+        player.resize(size.value(0).toInt(), size.value(1).toInt());
+        player.show();
+
+        QEventLoop loop;
+        QObject::connect(&player, &MpvWidget::initialized, &loop, &QEventLoop::quit);
+        QTimer::singleShot(10000, &loop, &QEventLoop::quit);
+        loop.exec();
+
+        // GL modes may have fallen back to software on this machine
+        QJsonObject modeResult{
+            {"requested_mode", VideoBackend::modeName(mode)},
+            {"render_mode", VideoBackend::modeName(player.renderMode())},
+        };
+        if (!player.handle()) {
+            qCritical() << "mpv did not initialize in" << VideoBackend::modeName(mode) << "mode";
+            modeResult["error"] = "mpv did not initialize";
+            modeResults.append(modeResult);
+            continue;
+        }
+
+        const QString tuning = parser.value(decodeTuningOpt);
+        QList<bool> tuningRuns;
+        if (tuning != "on")
+            tuningRuns << false;
+        if (tuning != "off")
+            tuningRuns << true;
+
+        QJsonArray results;
+        for (const BenchClip &clip : std::as_const(clips)) {
+            for (bool tuned : std::as_const(tuningRuns)) {
+                qInfo().noquote() << "bench:" << VideoBackend::modeName(mode) << clip.name()
+                                  << (tuned ? "tuned" : "untuned");
+                player.setDecodeTuning(tuned);
+                QJsonObject clipResult = runClip(&player, clip, seconds);
+                clipResult["decode_tuning"] = tuned;
+                results.append(clipResult);
+            }
+        }
+        modeResult["clips"] = results;
+
+        const int idleSeconds = parser.value(idleOpt).toInt();
+        if (idleSeconds > 0 && !clips.isEmpty() && clips.first().error.isEmpty())
+            modeResult["idle"] = runIdle(&player, clips.first(), idleSeconds);
+
+        const int roundTrips = parser.value(controlOpt).toInt();
+        if (roundTrips > 0)
+            modeResult["control_api"] = runControlLatency(&player, roundTrips);
+        modeResults.append(modeResult);
+    }
+
+    // Wall runs play in real time, each against as many separate player processes
+    QJsonArray wallResults;
+    if (parser.isSet(wallOpt) && !clips.isEmpty() && clips.first().error.isEmpty()) {
+        const QSize wallSize(size.value(0).toInt(), size.value(1).toInt());
+        const QString player = parser.value(playerOpt);
+        const bool compare = QFileInfo(player).isExecutable();
+        if (!compare)
+            qWarning() << "Player" << player << "not found; walls are not compared with separate processes";
+
+        for (int tileCount : parseInts(parser.value(wallOpt))) {
+            if (tileCount < 1)
+                continue;
+            qInfo().noquote() << "bench: wall" << tileCount << "tiles";
+            QJsonObject wallResult = runWall(clips.first(), tileCount, seconds, wallSize);
+
+            if (compare) {
+                qInfo().noquote() << "bench:" << tileCount << "separate players";
+                const QJsonObject separate = runSeparatePlayers(player, clips.first(), tileCount, seconds);
+                wallResult["separate"] = separate;
+
+                // Below 1.0 the wall is cheaper than that many single-stream players
+                if (separate["running"].toInt() == tileCount && separate["cpu_s"].toDouble() > 0)
+                    wallResult["cpu_vs_separate"] = wallResult["cpu_s"].toDouble() / separate["cpu_s"].toDouble();
+                if (separate["running"].toInt() == tileCount && separate["rss_kb"].toInteger() > 0)
+                    wallResult["rss_vs_separate"] = wallResult["rss_total_kb"].toDouble() / separate["rss_kb"].toDouble();
+            }
+            wallResults.append(wallResult);
+        }
+    }
+
+    QJsonObject report{
+        {"tool", "mpv_player_bench"},
+        {"mode", realtime ? "realtime" : "fast"},
+        {"platform", QGuiApplication::platformName()},
+        {"kernel", QSysInfo::kernelVersion()},
+        {"cpu_count", QThread::idealThreadCount()},
+        {"window", parser.value(sizeOpt)},
+        {"controls_pinned", parser.isSet(pinControlsOpt)},
+        {"http_kbps", parser.isSet(httpOpt) ? parser.value(httpOpt).toLongLong() : 0},
+        {"render_modes", modeResults},
+        {"wall", wallResults},
+        {"peak_rss_kb", peakRssKb()},
+    };
+
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    if (parser.isSet(outOpt)) {
+        QFile out(parser.value(outOpt));
+        if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qCritical() << "Cannot write" << out.fileName();
+            return 1;
+        }
+        out.write(json);
+    } else {
+        QTextStream(stdout) << json;
+    }
+
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include "throttledhttpserver.h"
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QTcpSocket>
+
+ThrottledHttpServer::ThrottledHttpServer(qint64 bytesPerSecond, QObject *parent)
+    : QObject(parent), bytesPerSecond(qMax<qint64>(1, bytesPerSecond))
+{
+    connect(&server, &QTcpServer::newConnection, this, &ThrottledHttpServer::onNewConnection);
+
+    pumpTimer.setInterval(kTickMs);
+    pumpTimer.setTimerType(Qt::PreciseTimer);
+    connect(&pumpTimer, &QTimer::timeout, this, &ThrottledHttpServer::pump);
+}
+
+ThrottledHttpServer::~ThrottledHttpServer()
+{
+    for (const Transfer &transfer : std::as_const(transfers))
+        delete transfer.file;
+}
+
+bool ThrottledHttpServer::listen()
+{
+    if (!server.listen(QHostAddress::LocalHost)) {
+        qWarning() << "HTTP server cannot listen:" << server.errorString();
+        return false;
+    }
+    return true;
+}
+
+QString ThrottledHttpServer::publish(const QString &filePath)
+{
+    const QString path = "/" + QFileInfo(filePath).fileName();
+    files.insert(path, filePath);
+    return QString("http://127.0.0.1:%1%2").arg(server.serverPort()).arg(path);
+}
+
+void ThrottledHttpServer::onNewConnection()
+{
+    while (QTcpSocket *socket = server.nextPendingConnection()) {
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() { finish(socket); });
+    }
+}
+
+void ThrottledHttpServer::onReadyRead(QTcpSocket *socket)
+{
+    if (transfers.contains(socket))
+        return;   // one request per connection
+
+    QByteArray &buffer = requests[socket];
+    buffer += socket->readAll();
+    if (!buffer.contains("\r\n\r\n"))
+        return;
+
+    const QByteArray request = buffer;
+    requests.remove(socket);
+    startTransfer(socket, request);
+}
+
+void ThrottledHttpServer::startTransfer(QTcpSocket *socket, const QByteArray &request)
+{
+    const QList<QByteArray> requestLine = request.left(request.indexOf("\r\n")).split(' ');
+    const QString path = requestLine.size() >= 2 ? QString::fromUtf8(requestLine.at(1)) : QString();
+
+    auto *file = new QFile(files.value(path));
+    if (requestLine.value(0) != "GET" || !file->open(QIODevice::ReadOnly)) {
+        delete file;
+        socket->write("HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+        socket->disconnectFromHost();
+        return;
+    }
+
+    const qint64 size = file->size();
+    qint64 first = 0;
+    qint64 last = size - 1;
+    bool partial = false;
+
+    static const QRegularExpression rangeRe("\r\nRange:\\s*bytes=(\\d+)-(\\d*)", QRegularExpression::CaseInsensitiveOption);
+    const QRegularExpressionMatch range = rangeRe.match(QString::fromLatin1(request));
+    if (range.hasMatch()) {
+        first = range.captured(1).toLongLong();
+        if (!range.captured(2).isEmpty())
+            last = qMin(last, range.captured(2).toLongLong());
+        partial = true;
+    }
+
+    if (first > last) {
+        delete file;
+        socket->write(QString("HTTP/1.1 416 Range Not Satisfiable\r\nContent-Range: bytes */%1\r\n"
+                              "Content-Length: 0\r\nConnection: close\r\n\r\n").arg(size).toLatin1());
+        socket->disconnectFromHost();
+        return;
+    }
+
+    QString header = partial ? QStringLiteral("HTTP/1.1 206 Partial Content\r\n") : QStringLiteral("HTTP/1.1 200 OK\r\n");
+    header += "Content-Type: application/octet-stream\r\nAccept-Ranges: bytes\r\nConnection: close\r\n";
+    header += QString("Content-Length: %1\r\n").arg(last - first + 1);
+    if (partial)
+        header += QString("Content-Range: bytes %1-%2/%3\r\n").arg(first).arg(last).arg(size);
+    header += "\r\n";
+    socket->write(header.toLatin1());
+
+    file->seek(first);
+    transfers.insert(socket, Transfer{file, last - first + 1});
+    if (!pumpTimer.isActive())
+        pumpTimer.start();
+}
+
+void ThrottledHttpServer::pump()
+{
+    const qint64 budget = qMax<qint64>(1, bytesPerSecond * kTickMs / 1000);
+
+    for (auto it = transfers.begin(); it != transfers.end(); ) {
+        QTcpSocket *socket = it.key();
+        Transfer &transfer = it.value();
+
+        // Keep at most one tick of data queued in the socket, or Qt would
+        // buffer the whole file and the limit would only apply to the kernel
+        if (socket->bytesToWrite() < budget) {
+            const QByteArray chunk = transfer.file->read(qMin(budget, transfer.remaining));
+            socket->write(chunk);
+            transfer.remaining -= chunk.size();
+        }
+
+        if (transfer.remaining <= 0 || transfer.file->atEnd()) {
+            delete transfer.file;
+            it = transfers.erase(it);
+            socket->disconnectFromHost();
+        } else {
+            ++it;
+        }
+    }
+
+    if (transfers.isEmpty())
+        pumpTimer.stop();
+}
+
+void ThrottledHttpServer::finish(QTcpSocket *socket)
+{
+    requests.remove(socket);
+    auto it = transfers.find(socket);
+    if (it != transfers.end()) {
+        delete it->file;
+        transfers.erase(it);
+    }
+    socket->deleteLater();
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QTcpServer>
+#include <QTimer>
+
+class QFile;
+class QTcpSocket;
+
+// Minimal HTTP/1.1 file server on 127.0.0.1 that caps each connection's
+// throughput, so cache behaviour and stalls can be measured under a
+// simulated link. Supports GET with single byte ranges, which mpv uses to seek.
+class ThrottledHttpServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ThrottledHttpServer(qint64 bytesPerSecond, QObject *parent = nullptr);
+    ~ThrottledHttpServer() override;
+
+    bool listen();
+    // URL under which the file is served
+    QString publish(const QString &filePath);
+
+private:
+    struct Transfer
+    {
+        QFile *file = nullptr;
+        qint64 remaining = 0;
+    };
+
+    void onNewConnection();
+    void onReadyRead(QTcpSocket *socket);
+    void startTransfer(QTcpSocket *socket, const QByteArray &request);
+    void pump();
+    void finish(QTcpSocket *socket);
+
+    static constexpr int kTickMs = 20;
+
+    QTcpServer server;
+    QTimer pumpTimer;
+    qint64 bytesPerSecond;
+    QHash<QString, QString> files;   // URL path -> local file
+    QHash<QTcpSocket *, QByteArray> requests;
+    QHash<QTcpSocket *, Transfer> transfers;
+};
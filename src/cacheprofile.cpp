@@ -0,0 +1,65 @@
+#include "cacheprofile.h"
+#include <QDebug>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <QUrl>
+
+static constexpr qint64 kMiB = 1024 * 1024;
+
+CacheProfiles::CacheProfiles()
+{
+    // mpv's own defaults; a local file needs no stream cache
+    profiles[Local] = {QStringLiteral("local"), false, 1, 150 * kMiB, 50 * kMiB, false};
+    // Ride out bandwidth dips and keep enough behind for short seeks back
+    profiles[Network] = {QStringLiteral("network"), true, 60, 256 * kMiB, 64 * kMiB, false};
+    // Reading far ahead of a live edge is impossible and seeking back rare
+    profiles[Live] = {QStringLiteral("live"), true, 10, 64 * kMiB, 16 * kMiB, false};
+}
+
+CacheProfiles::SourceType CacheProfiles::classify(const QString &url)
+{
+    const QUrl parsed(url);
+    const QString scheme = parsed.scheme().toLower();
+
+    // One-letter schemes are Windows drive letters
+    if (scheme.isEmpty() || scheme == QLatin1String("file") || scheme.size() == 1)
+        return Local;
+
+    static const QStringList liveSchemes = {"rtsp", "rtsps", "rtmp", "rtmps", "srt", "udp", "rtp"};
+    if (liveSchemes.contains(scheme) || parsed.path().endsWith(QLatin1String(".m3u8"), Qt::CaseInsensitive))
+        return Live;
+
+    return Network;
+}
+
+bool CacheProfiles::load(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QJsonParseError error;
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll(), &error).object();
+    if (error.error != QJsonParseError::NoError) {
+        qWarning() << "Ignoring cache profiles" << path << ":" << error.errorString();
+        return false;
+    }
+
+    if (root.contains("disk_cache_dir"))
+        diskCacheDir = root.value("disk_cache_dir").toString();
+
+    for (CacheProfile &profile : profiles) {
+        const QJsonObject o = root.value(profile.name).toObject();
+        if (o.isEmpty())
+            continue;
+
+        profile.cache = o.value("cache").toBool(profile.cache);
+        profile.readaheadSeconds = o.value("readahead_secs").toDouble(profile.readaheadSeconds);
+        profile.forwardBytes = static_cast<qint64>(o.value("forward_mib").toDouble(double(profile.forwardBytes) / kMiB) * kMiB);
+        profile.backBytes = static_cast<qint64>(o.value("back_mib").toDouble(double(profile.backBytes) / kMiB) * kMiB);
+        profile.onDisk = o.value("on_disk").toBool(profile.onDisk);
+    }
+    return true;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <QString>
+
+// Stream cache settings, passed to mpv as per-file options when a file is
+// opened or queued for gapless playback
+struct CacheProfile
+{
+    QString name;
+    bool cache = true;              // mpv "cache"
+    double readaheadSeconds = 0;    // cache-secs and demuxer-readahead-secs
+    qint64 forwardBytes = 0;        // demuxer-max-bytes
+    qint64 backBytes = 0;           // demuxer-max-back-bytes
+    bool onDisk = false;            // cache-on-disk, under diskCacheDir
+};
+
+// One profile per kind of source. Built-in defaults can be overridden from a
+// JSON file keyed by profile name:
+//   { "disk_cache_dir": "...",
+//     "network": { "readahead_secs": 120, "forward_mib": 512, "back_mib": 128, "on_disk": true } }
+class CacheProfiles
+{
+public:
+    enum SourceType {
+        Local,      // files and file:// URLs
+        Network,    // http(s), ftp and anything else with a scheme
+        Live,       // rtsp/rtmp/srt/udp and HLS playlists
+        SourceTypeCount
+    };
+
+    CacheProfiles();
+
+    static SourceType classify(const QString &url);
+    const CacheProfile &forUrl(const QString &url) const { return profiles[classify(url)]; }
+    const CacheProfile &profile(SourceType type) const { return profiles[type]; }
+
+    bool load(const QString &path);
+
+    QString diskCacheDir;
+
+private:
+    CacheProfile profiles[SourceTypeCount];
+};
@@ -2,8 +2,13 @@
 #include <QHBoxLayout>
 #include <QPainter>
 #include <QPainterPath>
-#include <QPropertyAnimation>
 #include <QGraphicsBlurEffect>
+#include <QTime>
+#include <QMouseEvent>
+
+static constexpr int kHideDelayMs = 2000;
+// The seek groove is inset by half the handle width on each side
+static constexpr int kGrooveInset = 7;
 
 ControlBar::ControlBar(QWidget *parent)
 : QWidget(parent)
@@ -15,10 +20,12 @@ ControlBar::ControlBar(QWidget *parent)
     setFixedHeight(120);
     setMinimumWidth(100);
 
-    // Create opacity effect for smooth fading
-    opacityEffect = new QGraphicsOpacityEffect(this);
-    opacityEffect->setOpacity(1.0);
-    setGraphicsEffect(opacityEffect);
+    // One animation for both fade directions; the effect is attached on demand
+    fadeAnimation = new QPropertyAnimation(this, "opacity", this);
+    connect(fadeAnimation, &QPropertyAnimation::finished, this, [this]() {
+        if (targetOpacity <= 0.0)
+            hide();
+    });
 
     // --- BUTTON SETUP ---
 /*
@@ -77,6 +84,9 @@ for (QPushButton *btn : {prevButton, playButton, nextButton}) {
 
     // SEEK SLIDER - styled like INNA
     seekSlider = new QSlider(Qt::Horizontal);
+    seekSlider->setRange(0, 1000);
+    seekSlider->setMouseTracking(true);
+    seekSlider->installEventFilter(this);
     seekSlider->setStyleSheet(
         "QSlider::groove:horizontal {"
         "   height: 4px;"
@@ -153,13 +163,18 @@ for (QPushButton *btn : {prevButton, playButton, nextButton}) {
 
     // Hide timer - auto-hide after 2 seconds of no mouse
     hideTimer = new QTimer(this);
-    hideTimer->setInterval(2000);
     hideTimer->setSingleShot(true);
 
     connect(hideTimer, &QTimer::timeout, this, [this]() {
-        if (!mouseInside) {
-            fadeOut();
+        if (mouseInside || pinned)
+            return;
+
+        const qint64 remaining = kHideDelayMs - lastActivity.elapsed();
+        if (remaining > 0) {
+            hideTimer->start(static_cast<int>(remaining));
+            return;
         }
+        fadeOut();
     });
 
     // Start visible
@@ -171,7 +186,53 @@ void ControlBar::paintEvent(QPaintEvent *event)
 {
     Q_UNUSED(event);
 
+    if (background.size() != size() * devicePixelRatioF())
+        updateBackground();
+
     QPainter painter(this);
+    painter.drawPixmap(0, 0, background);
+
+    // Buffered ranges as a thin strip under the seek groove
+    if (!shownRanges.isEmpty()) {
+        const QRect strip = cacheStripRect();
+        const int steps = seekSlider->maximum();
+        for (const auto &range : std::as_const(shownRanges)) {
+            const int x0 = strip.x() + strip.width() * range.first / steps;
+            const int x1 = strip.x() + strip.width() * range.second / steps;
+            painter.fillRect(QRect(x0, strip.y(), qMax(1, x1 - x0), strip.height()), QColor(255, 255, 255, 70));
+        }
+    }
+
+    // Chapter starts as short ticks above the groove
+    if (!shownChapters.isEmpty()) {
+        const QRect ticks = chapterTickRect();
+        const int steps = seekSlider->maximum();
+        for (int position : std::as_const(shownChapters)) {
+            const int x = ticks.x() + ticks.width() * position / steps;
+            painter.fillRect(QRect(x, ticks.y(), 2, ticks.height()), QColor(255, 255, 255, 140));
+        }
+    }
+}
+
+QRect ControlBar::cacheStripRect() const
+{
+    const QRect groove = seekSlider->geometry().adjusted(kGrooveInset, 0, -kGrooveInset, 0);
+    return QRect(groove.x(), groove.center().y() + 5, groove.width(), 2);
+}
+
+QRect ControlBar::chapterTickRect() const
+{
+    const QRect groove = seekSlider->geometry().adjusted(kGrooveInset, 0, -kGrooveInset, 0);
+    return QRect(groove.x(), groove.center().y() - 10, groove.width(), 4);
+}
+
+void ControlBar::updateBackground()
+{
+    background = QPixmap(size() * devicePixelRatioF());
+    background.setDevicePixelRatio(devicePixelRatioF());
+    background.fill(Qt::transparent);
+
+    QPainter painter(&background);
     painter.setRenderHint(QPainter::Antialiasing);
 
     // Draw rounded rectangle with blur-like appearance
@@ -190,57 +251,152 @@ void ControlBar::paintEvent(QPaintEvent *event)
     painter.drawRoundedRect(rect().adjusted(1, 1, -1, -1), 11, 11);
 }
 
-void ControlBar::fadeIn()
+void ControlBar::setOpacity(qreal opacity)
 {
-    if (targetOpacity >= 1.0 && opacityEffect->opacity() >= 0.99) {
-        return; // Already visible
+    currentOpacity = opacity;
+
+    // Fully opaque: paint straight into the backing store, no offscreen pass
+    if (opacity >= 1.0) {
+        if (opacityEffect) {
+            setGraphicsEffect(nullptr);   // deletes the effect
+            opacityEffect = nullptr;
+        }
+        return;
     }
 
-    targetOpacity = 1.0;
+    if (!opacityEffect) {
+        opacityEffect = new QGraphicsOpacityEffect(this);
+        setGraphicsEffect(opacityEffect);
+    }
+    opacityEffect->setOpacity(opacity);
+}
 
-    QPropertyAnimation *anim = new QPropertyAnimation(opacityEffect, "opacity");
-    anim->setDuration(200);
-    anim->setStartValue(opacityEffect->opacity());
-    anim->setEndValue(1.0);
-    anim->setEasingCurve(QEasingCurve::OutCubic);
-    anim->start(QAbstractAnimation::DeleteWhenStopped);
+void ControlBar::startFade(qreal target, int durationMs, QEasingCurve::Type curve)
+{
+    targetOpacity = target;
+    fadeAnimation->stop();
+    fadeAnimation->setDuration(durationMs);
+    fadeAnimation->setStartValue(currentOpacity);
+    fadeAnimation->setEndValue(target);
+    fadeAnimation->setEasingCurve(curve);
+    fadeAnimation->start();
+}
+
+void ControlBar::fadeIn()
+{
+    if (targetOpacity >= 1.0 && isVisible()) {
+        return; // Already visible or fading in
+    }
 
     show();
+    startFade(1.0, 200, QEasingCurve::OutCubic);
     resetHideTimer();
 }
 
 void ControlBar::fadeOut()
 {
-    if (mouseInside) {
+    if (mouseInside || pinned) {
         return; // Don't hide if mouse is over controls
     }
 
-    targetOpacity = 0.0;
+    // Hidden completely once the animation finishes
+    startFade(0.0, 300, QEasingCurve::InCubic);
+}
 
-    QPropertyAnimation *anim = new QPropertyAnimation(opacityEffect, "opacity");
-    anim->setDuration(300);
-    anim->setStartValue(opacityEffect->opacity());
-    anim->setEndValue(0.0);
-    anim->setEasingCurve(QEasingCurve::InCubic);
-    anim->start(QAbstractAnimation::DeleteWhenStopped);
+void ControlBar::setPinned(bool pin)
+{
+    pinned = pin;
+    if (pinned)
+        fadeIn();
+    else
+        resetHideTimer();
+}
 
-    // Hide completely after animation
-    QTimer::singleShot(300, this, [this]() {
-        if (targetOpacity <= 0.0) {
-            hide();
+void ControlBar::resetHideTimer()
+{
+    lastActivity.start();
+    if (!hideTimer->isActive())
+        hideTimer->start(kHideDelayMs);
+}
+
+void ControlBar::showState(const PlayerState &state, bool seeking)
+{
+    if (shownPaused != static_cast<int>(state.paused)) {
+        shownPaused = state.paused;
+        playButton->setIcon(QIcon(state.paused ? ":/icons/play.svg" : ":/icons/pause.svg"));
+    }
+
+    if (state.duration <= 0)
+        return;
+
+    // Quantized to slider steps, so a growing cache repaints only when visible
+    QList<QPair<int, int>> ranges;
+    ranges.reserve(state.cachedRanges.size());
+    for (const CacheRange &range : state.cachedRanges) {
+        ranges.append({qBound(0, qRound(range.start / state.duration * seekSlider->maximum()), seekSlider->maximum()),
+                       qBound(0, qRound(range.end / state.duration * seekSlider->maximum()), seekSlider->maximum())});
+    }
+    if (ranges != shownRanges) {
+        shownRanges = ranges;
+        update(cacheStripRect());
+    }
+
+    // The first chapter usually starts at zero and marks nothing
+    QList<int> chapters;
+    for (const ChapterInfo &chapter : state.chapters) {
+        if (chapter.time > 0 && chapter.time < state.duration)
+            chapters.append(qRound(chapter.time / state.duration * seekSlider->maximum()));
+    }
+    if (chapters != shownChapters) {
+        shownChapters = chapters;
+        update(chapterTickRect().adjusted(-1, 0, 2, 0));
+    }
+
+    if (!seeking) {
+        const int sliderPos = static_cast<int>((state.timePos / state.duration) * seekSlider->maximum());
+        if (sliderPos != shownSliderValue) {
+            shownSliderValue = sliderPos;
+            seekSlider->blockSignals(true);
+            seekSlider->setValue(sliderPos);
+            seekSlider->blockSignals(false);
         }
-    });
+    }
+
+    const int posSeconds = static_cast<int>(state.timePos);
+    const int durationSeconds = static_cast<int>(state.duration);
+    if (posSeconds == shownPosSeconds && durationSeconds == shownDurationSeconds)
+        return;
+
+    shownPosSeconds = posSeconds;
+    shownDurationSeconds = durationSeconds;
+
+    const QTime currentTime = QTime(0, 0, 0).addSecs(posSeconds);
+    const QTime totalTime = QTime(0, 0, 0).addSecs(durationSeconds);
+    const QString format = durationSeconds >= 3600 ? QStringLiteral("hh:mm:ss") : QStringLiteral("mm:ss");
+
+    timeLabel->setText(QString("%1 / %2").arg(currentTime.toString(format), totalTime.toString(format)));
 }
 
-void ControlBar::resetHideTimer()
+bool ControlBar::eventFilter(QObject *obj, QEvent *event)
 {
-    hideTimer->stop();
-    hideTimer->start();
+    if (obj == seekSlider) {
+        if (event->type() == QEvent::MouseMove) {
+            const auto *me = static_cast<QMouseEvent *>(event);
+            const int x = qRound(me->position().x());
+            const double fraction = qBound(0.0, double(x - kGrooveInset) / qMax(1, seekSlider->width() - 2 * kGrooveInset), 1.0);
+            emit seekHovered(fraction, seekSlider->x() + x);
+        } else if (event->type() == QEvent::Leave) {
+            emit seekHoverEnded();
+        }
+    }
+
+    return QWidget::eventFilter(obj, event);
 }
 
 void ControlBar::resizeEvent(QResizeEvent *event)
 {
     QWidget::resizeEvent(event);
+    updateBackground();
 }
 
 void ControlBar::enterEvent(QEnterEvent *event)
@@ -5,10 +5,18 @@
 #include <QLabel>
 #include <QTimer>
 #include <QGraphicsOpacityEffect>
+#include <QElapsedTimer>
+#include <QPixmap>
+#include <QPropertyAnimation>
+#include "playerstate.h"
 
+// The bar is cheap to keep on screen over video: its background is drawn
+// once per size into a pixmap, and the opacity effect (which renders the
+// whole bar offscreen on every repaint) only exists while a fade runs.
 class ControlBar : public QWidget
 {
     Q_OBJECT
+    Q_PROPERTY(qreal opacity READ opacity WRITE setOpacity)
 
 public:
     explicit ControlBar(QWidget *parent = nullptr);
@@ -16,18 +24,54 @@ public:
     void fadeIn();
     void fadeOut();
     void resetHideTimer();
+    void cancelHideTimer() { hideTimer->stop(); }
+
+    // Keep the bar shown regardless of the mouse (benchmarks, kiosks)
+    void setPinned(bool pinned);
+
+    qreal opacity() const { return currentOpacity; }
+    void setOpacity(qreal opacity);
+
+    // Update widgets from a state snapshot; only touches what visibly changed
+    void showState(const PlayerState &state, bool seeking);
+
+signals:
+    // Mouse over the seek slider: position along the groove (0..1) and x in bar coordinates
+    void seekHovered(double fraction, int x);
+    void seekHoverEnded();
 
 protected:
+    bool eventFilter(QObject *obj, QEvent *event) override;
     void resizeEvent(QResizeEvent *event) override;
     void enterEvent(QEnterEvent *event) override;
     void leaveEvent(QEvent *event) override;
     void paintEvent(QPaintEvent *event) override;
 
 private:
+    void startFade(qreal target, int durationMs, QEasingCurve::Type curve);
+    QRect cacheStripRect() const;
+    QRect chapterTickRect() const;
+    void updateBackground();
+
+    // Armed once and re-armed for the remainder on expiry, so mouse
+    // movement only records a timestamp
     QTimer *hideTimer;
-    QGraphicsOpacityEffect *opacityEffect;
+    QElapsedTimer lastActivity;
+    QGraphicsOpacityEffect *opacityEffect = nullptr;
+    QPropertyAnimation *fadeAnimation;
+    QPixmap background;
+    qreal currentOpacity = 1.0;
     qreal targetOpacity = 1.0;
     bool mouseInside = false;
+    bool pinned = false;
+
+    // Last values pushed to the widgets
+    int shownSliderValue = -1;
+    int shownPosSeconds = -1;
+    int shownDurationSeconds = -1;
+    int shownPaused = -1;
+    QList<QPair<int, int>> shownRanges;   // buffered ranges in slider units
+    QList<int> shownChapters;             // chapter starts in slider units
 
 public:
     QPushButton *playButton;
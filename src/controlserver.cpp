@@ -0,0 +1,318 @@
+#include "controlserver.h"
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLocalSocket>
+#include <QProcess>
+#include "mpvwidget.h"
+
+ControlServer::ControlServer(MpvWidget *player, QObject *parent)
+    : QObject(parent), player(player)
+{
+    server.setSocketOptions(QLocalServer::UserAccessOption);
+    connect(&server, &QLocalServer::newConnection, this, &ControlServer::onNewConnection);
+
+    // Player state changes many times per frame; subscribers see the sum
+    deltaTimer = new QTimer(this);
+    deltaTimer->setSingleShot(true);
+    deltaTimer->setInterval(kDeltaIntervalMs);
+    connect(deltaTimer, &QTimer::timeout, this, &ControlServer::sendDeltas);
+    connect(player, &MpvWidget::stateChanged, this, &ControlServer::onStateChanged);
+}
+
+ControlServer::~ControlServer()
+{
+    // Sockets are children of the server; drop our bookkeeping first
+    clients.clear();
+}
+
+bool ControlServer::listen(const QString &name)
+{
+    // Only a socket left behind by a crashed player may be taken over
+    QLocalSocket probe;
+    probe.connectToServer(name);
+    if (probe.waitForConnected(kLiveCheckMs)) {
+        probe.abort();
+        qWarning() << "Control socket" << name << "is in use by another player";
+        return false;
+    }
+    QLocalServer::removeServer(name);
+
+    if (!server.listen(name)) {
+        qWarning() << "Control server cannot listen on" << name << ":" << server.errorString();
+        return false;
+    }
+    return true;
+}
+
+void ControlServer::onNewConnection()
+{
+    while (QLocalSocket *socket = server.nextPendingConnection()) {
+        clients.insert(socket, Client());
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+            clients.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void ControlServer::onReadyRead(QLocalSocket *socket)
+{
+    auto it = clients.find(socket);
+    if (it == clients.end())
+        return;
+
+    Client &client = it.value();
+    client.buffer += socket->readAll();
+
+    // Everything complete in this read is one batch with one write back
+    const int end = client.buffer.lastIndexOf('\n');
+    if (end < 0) {
+        if (client.buffer.size() > kMaxLineBytes) {
+            qWarning() << "Control client sent an overlong line; closing";
+            socket->disconnectFromServer();
+        }
+        return;
+    }
+
+    const QByteArray batch = client.buffer.left(end);
+    client.buffer.remove(0, end + 1);
+
+    QByteArray replies;
+    for (const QByteArray &rawLine : batch.split('\n')) {
+        const QByteArray line = rawLine.trimmed();
+        if (line.isEmpty())
+            continue;
+        replies += QJsonDocument(execute(client, line)).toJson(QJsonDocument::Compact);
+        replies += '\n';
+    }
+    socket->write(replies);
+}
+
+QJsonObject ControlServer::execute(Client &client, const QByteArray &line)
+{
+    QJsonObject reply;
+    QString command;
+    QJsonArray args;
+
+    if (line.startsWith('{')) {
+        QJsonParseError parseError;
+        const QJsonObject request = QJsonDocument::fromJson(line, &parseError).object();
+        if (parseError.error != QJsonParseError::NoError) {
+            reply["ok"] = false;
+            reply["error"] = parseError.errorString();
+            return reply;
+        }
+        if (request.contains("id"))
+            reply["id"] = request.value("id");
+        command = request.value("command").toString();
+        args = request.value("args").toArray();
+    } else {
+        // Plain words; quote arguments that contain spaces
+        QStringList words = QProcess::splitCommand(QString::fromUtf8(line));
+        if (!words.isEmpty())
+            command = words.takeFirst();
+        args = QJsonArray::fromStringList(words);
+    }
+
+    QString error;
+    const QJsonValue result = run(client, command.toLower(), args, &error);
+    reply["ok"] = error.isEmpty();
+    if (error.isEmpty()) {
+        if (!result.isNull())
+            reply["result"] = result;
+    } else {
+        reply["error"] = error;
+    }
+    return reply;
+}
+
+QJsonValue ControlServer::run(Client &client, const QString &command, const QJsonArray &args, QString *error)
+{
+    auto argString = [&args](int i) { return args.at(i).toVariant().toString(); };
+    auto argNumber = [&args](int i, bool *ok) {
+        if (args.at(i).isDouble()) {
+            *ok = true;
+            return args.at(i).toDouble();
+        }
+        return args.at(i).toString().toDouble(ok);
+    };
+
+    if (command == "ping")
+        return QStringLiteral("pong");
+
+    if (command == "load") {
+        if (args.isEmpty()) {
+            *error = "load needs a file or URL";
+            return {};
+        }
+        player->play(argString(0));
+        return {};
+    }
+
+    if (command == "enqueue") {
+        QStringList urls;
+        for (int i = 0; i < args.size(); ++i)
+            urls << argString(i);
+        return player->enqueue(urls);
+    }
+
+    if (command == "seek") {
+        bool ok = false;
+        const double seconds = args.isEmpty() ? 0 : argNumber(0, &ok);
+        if (!ok) {
+            *error = "seek needs a position in seconds";
+            return {};
+        }
+        player->seek(seconds, args.size() > 1 && argString(1) == "relative");
+        return {};
+    }
+
+    if (command == "pause") {
+        const QString mode = args.isEmpty() ? QStringLiteral("toggle") : argString(0);
+        if (mode == "toggle")
+            player->setPaused(!player->playerState().paused);
+        else if (mode == "yes" || mode == "true" || mode == "1")
+            player->setPaused(true);
+        else if (mode == "no" || mode == "false" || mode == "0")
+            player->setPaused(false);
+        else
+            *error = "pause takes yes, no or toggle";
+        return {};
+    }
+
+    if (command == "capture") {
+        bool countOk = true, intervalOk = true;
+        const int count = args.isEmpty() ? 1 : static_cast<int>(argNumber(0, &countOk));
+        const int interval = args.size() < 2 ? 100 : static_cast<int>(argNumber(1, &intervalOk));
+        if (!countOk || !intervalOk || count < 1 || interval < 1)
+            *error = "capture takes a frame count and an interval in ms";
+        else if (count == 1 && !player->captureFrame())
+            *error = QStringLiteral("capture queue full");
+        else if (count > 1)
+            player->captureBurst(count, interval);
+        return {};
+    }
+
+    if (command == "memory") {
+        QJsonObject report = player->memoryUsage().toJson();
+        report.insert("budget", player->memoryBudget().toJson());
+        return report;
+    }
+
+    if (command == "audio_only") {
+        const QString mode = args.isEmpty() ? QStringLiteral("toggle") : argString(0);
+        if (mode == "toggle")
+            player->setAudioOnly(!player->audioOnlyEnabled());
+        else if (mode == "yes" || mode == "true" || mode == "1")
+            player->setAudioOnly(true);
+        else if (mode == "no" || mode == "false" || mode == "0")
+            player->setAudioOnly(false);
+        else
+            *error = "audio_only takes yes, no or toggle";
+        return {};
+    }
+
+    if (command == "next") {
+        player->playNext();
+        return {};
+    }
+
+    if (command == "prev") {
+        player->playPrev();
+        return {};
+    }
+
+    if (command == "state")
+        return snapshot();
+
+    if (command == "subscribe") {
+        client.subscribed = true;
+        client.fields.clear();
+        for (int i = 0; i < args.size(); ++i)
+            client.fields.insert(argString(i));
+
+        // The reply carries the starting point; events only carry changes
+        client.lastSent = select(snapshot(), client.fields);
+        return client.lastSent;
+    }
+
+    if (command == "unsubscribe") {
+        client.subscribed = false;
+        client.lastSent = QJsonObject();
+        return {};
+    }
+
+    *error = command.isEmpty() ? QStringLiteral("empty command") : "unknown command " + command;
+    return {};
+}
+
+QJsonObject ControlServer::snapshot() const
+{
+    const PlayerState &state = player->playerState();
+    const Playlist &playlist = player->playlistEntries();
+
+    return QJsonObject{
+        {"position", state.timePos},
+        {"duration", state.duration},
+        {"paused", state.paused},
+        {"buffering", state.pausedForCache},
+        {"cache_seconds", state.cacheDuration},
+        {"has_video", state.hasVideo()},
+        {"audio_only", player->isAudioOnly()},
+        {"playlist_index", playlist.currentIndex()},
+        {"playlist_size", playlist.size()},
+        {"url", playlist.currentIndex() >= 0 ? playlist.url(playlist.currentIndex()) : QString()},
+    };
+}
+
+QJsonObject ControlServer::select(const QJsonObject &state, const QSet<QString> &fields)
+{
+    if (fields.isEmpty())
+        return state;
+
+    QJsonObject selected;
+    for (const QString &field : fields) {
+        if (state.contains(field))
+            selected[field] = state.value(field);
+    }
+    return selected;
+}
+
+void ControlServer::onStateChanged()
+{
+    if (deltaTimer->isActive())
+        return;
+
+    for (const Client &client : std::as_const(clients)) {
+        if (client.subscribed) {
+            deltaTimer->start();
+            return;
+        }
+    }
+}
+
+void ControlServer::sendDeltas()
+{
+    const QJsonObject state = snapshot();
+
+    for (auto it = clients.begin(); it != clients.end(); ++it) {
+        Client &client = it.value();
+        if (!client.subscribed)
+            continue;
+
+        QJsonObject changes;
+        const QJsonObject current = select(state, client.fields);
+        for (auto field = current.constBegin(); field != current.constEnd(); ++field) {
+            if (client.lastSent.value(field.key()) != field.value())
+                changes[field.key()] = field.value();
+        }
+        if (changes.isEmpty())
+            continue;
+
+        client.lastSent = current;
+        const QJsonObject event{{"event", "state"}, {"changes", changes}};
+        it.key()->write(QJsonDocument(event).toJson(QJsonDocument::Compact) + '\n');
+    }
+}
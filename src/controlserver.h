@@ -0,0 +1,62 @@
+#pragma once
+#include <QByteArray>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QLocalServer>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+
+class MpvWidget;
+class QLocalSocket;
+
+// Remote control over a local socket, for automation. One command per line,
+// either plain words ("seek 30", "enqueue a.mkv b.mkv") or a JSON object
+// ({"id": 1, "command": "seek", "args": [30]}). Every command gets a JSON
+// reply line, in order. Lines that arrive in one read run as one batch and
+// their replies go out in one write. Subscribers get state changes as deltas,
+// at most one message per kDeltaIntervalMs.
+class ControlServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ControlServer(MpvWidget *player, QObject *parent = nullptr);
+    ~ControlServer() override;
+
+    // A bare name lives in the runtime directory; a stale socket is replaced
+    bool listen(const QString &name);
+    QString serverPath() const { return server.fullServerName(); }
+
+private:
+    struct Client
+    {
+        QByteArray buffer;
+        bool subscribed = false;
+        QSet<QString> fields;   // empty: all
+        QJsonObject lastSent;
+    };
+
+    void onNewConnection();
+    void onReadyRead(QLocalSocket *socket);
+    void onStateChanged();
+    void sendDeltas();
+
+    QJsonObject execute(Client &client, const QByteArray &line);
+    QJsonValue run(Client &client, const QString &command, const QJsonArray &args, QString *error);
+    QJsonObject snapshot() const;
+    static QJsonObject select(const QJsonObject &state, const QSet<QString> &fields);
+
+    static constexpr int kDeltaIntervalMs = 100;
+    // A live player answers a connect on its socket well within this
+    static constexpr int kLiveCheckMs = 200;
+    static constexpr int kMaxLineBytes = 1024 * 1024;
+
+    MpvWidget *player;
+    QLocalServer server;
+    QHash<QLocalSocket *, Client> clients;
+    QTimer *deltaTimer;
+};
@@ -0,0 +1,164 @@
+#include "decodetuner.h"
+#include "mpvproperty.h"
+#include <QDebug>
+#include <QVariantList>
+#include <QVariantMap>
+#include <cmath>
+#include <cstring>
+
+// libavcodec frame threading stops scaling well past this
+static constexpr int kMaxThreads = 16;
+// Dropping this many frames per second of playback calls for a step up
+static constexpr double kDropsPerSecond = 0.5;
+static constexpr double kMinSecondsForDrops = 3;
+
+// Options apply() writes, with mpv's defaults
+static const char *const kOwnedOptions[][2] = {
+    {"vd-lavc-threads", "0"},
+    {"vd-lavc-o", ""},
+    {"vd-lavc-fast", "no"},
+    {"vd-lavc-skiploopfilter", "default"},
+};
+
+// vd-lavc-o is a key=value list; only thread_type is ours
+static QByteArray withThreadType(const QByteArray &lavcOptions, const char *threadType)
+{
+    QList<QByteArray> entries;
+    for (const QByteArray &entry : lavcOptions.split(',')) {
+        if (!entry.isEmpty() && !entry.startsWith("thread_type="))
+            entries << entry;
+    }
+    entries << QByteArray("thread_type=") + threadType;
+    return entries.join(',');
+}
+
+// Rough software decode cost per pixel, relative to H.264
+static double codecWeight(const QString &codec)
+{
+    static const QHash<QString, double> weights = {
+        {"mpeg2video", 0.5}, {"mpeg4", 0.6}, {"h264", 1.0}, {"vp8", 1.0},
+        {"vp9", 1.5}, {"hevc", 1.7}, {"av1", 2.2}, {"vvc", 3.0},
+    };
+    return weights.value(codec, 1.0);
+}
+
+double DecodeInput::load() const
+{
+    const double rate = fps > 0 ? fps : 30;
+    return width * double(height) * rate * codecWeight(codec) / (1920.0 * 1080.0 * 30.0);
+}
+
+QString DecodeInput::classKey() const
+{
+    // Heights grouped so 1080p and 1088p, or 60 and 59.94 fps, learn together
+    return QString("%1/%2p%3").arg(codec).arg((height + 64) / 360 * 360).arg(qRound(fps / 30) * 30);
+}
+
+DecodeInput DecodeInput::fromTrackList(const QVariant &trackList, bool live)
+{
+    DecodeInput input;
+    input.live = live;
+
+    QVariantMap chosen;
+    for (const QVariant &entry : trackList.toList()) {
+        const QVariantMap track = entry.toMap();
+        if (track.value("type").toString() != QLatin1String("video") || track.value("albumart").toBool())
+            continue;
+        if (chosen.isEmpty() || track.value("selected").toBool())
+            chosen = track;
+    }
+
+    input.codec = chosen.value("codec").toString();
+    input.width = chosen.value("demux-w").toInt();
+    input.height = chosen.value("demux-h").toInt();
+    input.fps = chosen.value("demux-fps").toDouble();
+    return input;
+}
+
+QString DecodeConfig::describe() const
+{
+    QString text = threads > 0 ? QString("%1 threads").arg(threads) : QStringLiteral("auto threads");
+    text += sliceThreads ? " slice" : " frame";
+    if (fast)
+        text += ", fast";
+    if (!skipLoopFilter.isEmpty())
+        text += ", skip loop filter " + skipLoopFilter;
+    if (level > 0)
+        text += QString(", level %1").arg(level);
+    return text;
+}
+
+DecodeTuner::DecodeTuner(int cores) : cores(qMax(1, cores))
+{
+}
+
+DecodeConfig DecodeTuner::choose(const DecodeInput &input) const
+{
+    DecodeConfig config;
+    if (!input.isValid())
+        return config;
+
+    const int available = qMin(cores, kMaxThreads);
+    config.level = levels.value(input.classKey(), 0);
+
+    // About two threads per 1080p30 H.264 worth of work; small files get few
+    // so they do not spin up a thread per core for nothing
+    config.threads = qBound(1, static_cast<int>(std::ceil(input.load() * 2)), available);
+    if (config.level >= 1)
+        config.threads = available;
+
+    // Frame threading delays output by a frame per thread; live sources
+    // trade some throughput for latency
+    config.sliceThreads = input.live && config.threads > 1;
+
+    // Even every core may not be enough; give up exactness before frames
+    const bool overloaded = input.load() * 2 > available;
+    config.fast = overloaded || config.level >= 2;
+    if (config.level >= 3)
+        config.skipLoopFilter = QStringLiteral("all");
+    else if (overloaded || config.level >= 2)
+        config.skipLoopFilter = QStringLiteral("nonref");
+
+    return config;
+}
+
+void DecodeTuner::apply(mpv_handle *mpv, const DecodeConfig &config) const
+{
+    auto user = [this](const char *name) {
+        for (const auto &option : kOwnedOptions) {
+            if (!strcmp(option[0], name))
+                return userOptions.value(name, option[1]);
+        }
+        return QByteArray();
+    };
+
+    // Read when the decoder is created, which follows this
+    mpvSetOption(mpv, "vd-lavc-threads", config.threads > 0 ? QByteArray::number(config.threads) : user("vd-lavc-threads"));
+    mpvSetOption(mpv, "vd-lavc-o", config.sliceThreads ? withThreadType(user("vd-lavc-o"), "slice") : user("vd-lavc-o"));
+    mpvSetOption(mpv, "vd-lavc-fast", config.fast ? QByteArray("yes") : user("vd-lavc-fast"));
+    mpvSetOption(mpv, "vd-lavc-skiploopfilter", config.skipLoopFilter.isEmpty() ? user("vd-lavc-skiploopfilter") : config.skipLoopFilter.toUtf8());
+}
+
+bool DecodeTuner::setUserOption(const QByteArray &name, const QByteArray &value)
+{
+    for (const auto &option : kOwnedOptions) {
+        if (name == option[0]) {
+            userOptions.insert(name, value);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DecodeTuner::reportDrops(const DecodeInput &input, qint64 drops, double playedSeconds)
+{
+    if (!input.isValid() || playedSeconds < kMinSecondsForDrops || drops / playedSeconds < kDropsPerSecond)
+        return false;
+
+    int &level = levels[input.classKey()];
+    if (level >= kMaxLevel)
+        return false;
+
+    ++level;
+    return true;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <QHash>
+#include <QString>
+#include <QVariant>
+#include <mpv/client.h>
+
+// What the software decoder will be asked to do, from the demuxer's view
+struct DecodeInput
+{
+    QString codec;
+    int width = 0;
+    int height = 0;
+    double fps = 0;
+    bool live = false;
+
+    bool isValid() const { return !codec.isEmpty() && width > 0 && height > 0; }
+    // Load relative to 1080p30 H.264
+    double load() const;
+    // Files of one class share what was learned about them
+    QString classKey() const;
+
+    // Video track mpv will pick (the selected one, else the first)
+    static DecodeInput fromTrackList(const QVariant &trackList, bool live);
+};
+
+struct DecodeConfig
+{
+    int threads = 0;              // 0: left to libavcodec
+    bool sliceThreads = false;    // slice instead of frame threading
+    bool fast = false;            // vd-lavc-fast: non spec compliant speedups
+    QString skipLoopFilter;       // vd-lavc-skiploopfilter, empty for the default
+    int level = 0;                // escalation steps taken after dropped frames
+
+    QString describe() const;
+};
+
+// Picks libavcodec threading and speed/quality trade-offs per file from core
+// count, codec, resolution and frame rate. Classes of files that still drop
+// decoder frames get stepped up (more threads, then fast decoding, then
+// skipping the loop filter) for the next decoder created for them, the
+// reloaded decoder of the file that dropped included. Decode speed itself is
+// not timed: decoder drops per second of playback stand in for it. Only the
+// software path is affected; hardware decoding ignores these options.
+class DecodeTuner
+{
+public:
+    explicit DecodeTuner(int cores);
+
+    DecodeConfig choose(const DecodeInput &input) const;
+    // Options left alone by the config keep what the user set; a default
+    // DecodeConfig puts all of them back
+    void apply(mpv_handle *mpv, const DecodeConfig &config) const;
+
+    // Records a user-set option if it is one apply() writes; true if so
+    bool setUserOption(const QByteArray &name, const QByteArray &value);
+
+    // Decoder drops seen over some unpaused playback with choose()'s config
+    // for this input; true when its class was stepped up
+    bool reportDrops(const DecodeInput &input, qint64 drops, double playedSeconds);
+
+    static constexpr int kMaxLevel = 3;
+
+private:
+    int cores;
+    QHash<QString, int> levels;   // escalation per class
+    QHash<QByteArray, QByteArray> userOptions;
+};
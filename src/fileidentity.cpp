@@ -0,0 +1,21 @@
+#include "fileidentity.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QUrl>
+
+QString fileIdentity(const QString &url, QString *localPath)
+{
+    const QFileInfo info(url.startsWith("file://") ? QUrl(url).toLocalFile() : url);
+    if (!info.isFile())
+        return QString();
+
+    const QString path = info.absoluteFilePath();
+    if (localPath)
+        *localPath = path;
+
+    const QByteArray identity = path.toUtf8() + '\n'
+        + QByteArray::number(info.size()) + '\n'
+        + QByteArray::number(info.lastModified().toMSecsSinceEpoch());
+    return QString::fromLatin1(QCryptographicHash::hash(identity, QCryptographicHash::Sha1).toHex());
+}
@@ -0,0 +1,7 @@
+#pragma once
+#include <QString>
+
+// Stable id for a local file: hash of absolute path, size and mtime, so an
+// edited or replaced file gets a new id. Empty for anything that is not a
+// local file (streams, missing paths). `localPath` receives the resolved path.
+QString fileIdentity(const QString &url, QString *localPath = nullptr);
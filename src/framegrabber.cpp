@@ -0,0 +1,279 @@
+#include "framegrabber.h"
+#include "mpveventthread.h"
+#include <QDebug>
+#include <QDir>
+#include <QImageWriter>
+#include <QStandardPaths>
+#include <QThread>
+#include <cstring>
+
+// Quality for the lossy formats
+static constexpr int kQuality = 92;
+// Pool buffers are kept this long after the last grab
+static constexpr int kTrimDelayMs = 10000;
+
+int FramePool::store(const mpv_node *result)
+{
+    if (result->format != MPV_FORMAT_NODE_MAP)
+        return -1;
+
+    int64_t w = 0, h = 0, stride = 0;
+    const char *format = nullptr;
+    const mpv_byte_array *data = nullptr;
+    for (int i = 0; i < result->u.list->num; ++i) {
+        const char *key = result->u.list->keys[i];
+        const mpv_node &value = result->u.list->values[i];
+        if (!strcmp(key, "w") && value.format == MPV_FORMAT_INT64)
+            w = value.u.int64;
+        else if (!strcmp(key, "h") && value.format == MPV_FORMAT_INT64)
+            h = value.u.int64;
+        else if (!strcmp(key, "stride") && value.format == MPV_FORMAT_INT64)
+            stride = value.u.int64;
+        else if (!strcmp(key, "format") && value.format == MPV_FORMAT_STRING)
+            format = value.u.string;
+        else if (!strcmp(key, "data") && value.format == MPV_FORMAT_BYTE_ARRAY)
+            data = value.u.ba;
+    }
+
+    // bgr0 and bgra are Qt's 32-bit formats on little-endian machines
+    QImage::Format imageFormat;
+    if (format && !strcmp(format, "bgr0"))
+        imageFormat = QImage::Format_RGB32;
+    else if (format && !strcmp(format, "bgra"))
+        imageFormat = QImage::Format_ARGB32;
+    else
+        return -1;
+
+    const qsizetype size = static_cast<qsizetype>(stride * h);
+    if (w <= 0 || h <= 0 || stride < w * 4 || !data || static_cast<qsizetype>(data->size) < size)
+        return -1;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    lastSize = size;
+
+    // A free buffer already big enough costs nothing more
+    int chosen = -1;
+    for (int i = 0; i < kSlots; ++i) {
+        const Slot &slot = buffers[i];
+        if (slot.busy)
+            continue;
+        if (chosen < 0 || (slot.buffer.capacity() >= size && buffers[chosen].buffer.capacity() < size))
+            chosen = i;
+    }
+    if (chosen < 0)
+        return -1;
+
+    Slot &slot = buffers[chosen];
+    if (limit >= 0) {
+        const qint64 grown = qMax<qint64>(0, size - slot.buffer.capacity());
+        if (allocatedLocked() + grown > limit) {
+            // Other free buffers make room first; one frame always fits
+            for (Slot &other : buffers) {
+                if (!other.busy && &other != &slot)
+                    other.buffer = QByteArray();
+            }
+            const qint64 others = allocatedLocked() - slot.buffer.capacity();
+            if (others > 0 && others + qMax<qint64>(size, slot.buffer.capacity()) > limit)
+                return -1;
+        }
+    }
+
+    // Same-sized frames reuse the allocation
+    slot.buffer.resize(size);
+    memcpy(slot.buffer.data(), data->data, static_cast<size_t>(size));
+    slot.image = QImage(reinterpret_cast<const uchar *>(slot.buffer.constData()),
+                        static_cast<int>(w), static_cast<int>(h), static_cast<qsizetype>(stride), imageFormat);
+    slot.busy = true;
+    return chosen;
+}
+
+QImage FramePool::image(int slot) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return buffers[slot].image;
+}
+
+void FramePool::release(int slot)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    buffers[slot].image = QImage();
+    buffers[slot].busy = false;
+}
+
+void FramePool::trim()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    trimLocked(0);
+}
+
+qint64 FramePool::bytesAllocated() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return allocatedLocked();
+}
+
+void FramePool::setLimit(qint64 bytes)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    limit = bytes;
+    if (limit >= 0)
+        trimLocked(limit);
+}
+
+qint64 FramePool::lastFrameBytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return lastSize;
+}
+
+qint64 FramePool::allocatedLocked() const
+{
+    qint64 total = 0;
+    for (const Slot &slot : buffers)
+        total += slot.buffer.capacity();
+    return total;
+}
+
+void FramePool::trimLocked(qint64 keep)
+{
+    qint64 total = allocatedLocked();
+    for (Slot &slot : buffers) {
+        if (total <= keep)
+            return;
+        if (!slot.busy) {
+            total -= slot.buffer.capacity();
+            slot.buffer = QByteArray();
+        }
+    }
+}
+
+FrameGrabber::FrameGrabber(QObject *parent)
+: QObject(parent)
+{
+    clock.start();
+    directory = QStandardPaths::writableLocation(QStandardPaths::PicturesLocation);
+
+    // Encoding is CPU-bound; leave most cores to playback
+    encoders.setMaxThreadCount(qMax(1, QThread::idealThreadCount() / 2));
+
+    burstTimer = new QTimer(this);
+    connect(burstTimer, &QTimer::timeout, this, [this]() {
+        if (!capture(burstName))
+            counters.dropped++;
+        if (--burstRemaining <= 0)
+            burstTimer->stop();
+    });
+
+    trimTimer = new QTimer(this);
+    trimTimer->setSingleShot(true);
+    trimTimer->setInterval(kTrimDelayMs);
+    connect(trimTimer, &QTimer::timeout, this, [this]() { framePool.trim(); });
+}
+
+FrameGrabber::~FrameGrabber()
+{
+    // Encoders still write into pool buffers and report back to this object
+    encoders.waitForDone();
+}
+
+bool FrameGrabber::setFormat(const QString &name)
+{
+    const QByteArray requested = name.toLower().toLatin1();
+    if (!QImageWriter::supportedImageFormats().contains(requested)) {
+        qWarning() << "No image writer for" << name << "- keeping" << format;
+        return false;
+    }
+    format = requested;
+    return true;
+}
+
+bool FrameGrabber::capture(const QString &baseName)
+{
+    if (!mpv)
+        return false;
+
+    // Every grab in flight may be holding a pool buffer
+    if (counters.queued >= FramePool::kSlots)
+        return false;
+
+    // Each grab in flight needs about a frame; the pool refuses the rest
+    // anyway, but refusing here spares mpv the screenshot
+    const qint64 frameBytes = framePool.lastFrameBytes();
+    if (memoryLimit >= 0 && counters.queued > 0 && (counters.queued + 1) * frameBytes > memoryLimit)
+        return false;
+
+    // "video": the decoded frame at its own size, without subtitles or OSD
+    const char *cmd[] = {"screenshot-raw", "video", nullptr};
+    int r = mpv_command_async(mpv, AsyncScreenshot, cmd);
+    if (r < 0) {
+        qWarning() << "Failed to queue frame grab:" << mpv_error_string(r);
+        return false;
+    }
+
+    Request request;
+    request.path = QDir(directory).filePath(QString("%1-%2.%3").arg(baseName).arg(++sequence).arg(QString::fromLatin1(format)));
+    request.issuedNs = clock.nsecsElapsed();
+    requests.enqueue(request);
+
+    counters.queued++;
+    counters.peakQueued = qMax(counters.peakQueued, counters.queued);
+    trimTimer->stop();
+    return true;
+}
+
+void FrameGrabber::captureBurst(const QString &baseName, int count, int intervalMs)
+{
+    if (count <= 0)
+        return;
+
+    burstName = baseName;
+    burstRemaining = count - 1;
+    if (!capture(baseName))
+        counters.dropped++;
+    if (burstRemaining > 0)
+        burstTimer->start(qMax(1, intervalMs));
+}
+
+void FrameGrabber::commandReply(int error, int slot)
+{
+    if (requests.isEmpty())
+        return;
+    const Request request = requests.dequeue();
+
+    if (error < 0 || slot < 0) {
+        finish(false, request.path, request.issuedNs,
+               error < 0 ? QString::fromUtf8(mpv_error_string(error)) : QStringLiteral("no frame buffer free under the memory limit"));
+        return;
+    }
+
+    QDir().mkpath(directory);
+    const QByteArray writeFormat = format;
+    encoders.start([this, slot, request, writeFormat]() {
+        QImageWriter writer(request.path, writeFormat);
+        writer.setQuality(kQuality);
+        const bool ok = writer.write(framePool.image(slot));
+        const QString error = ok ? QString() : writer.errorString();
+        framePool.release(slot);
+
+        QMetaObject::invokeMethod(this, [this, ok, request, error]() {
+            finish(ok, request.path, request.issuedNs, error);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void FrameGrabber::finish(bool ok, const QString &path, qint64 issuedNs, const QString &error)
+{
+    counters.queued--;
+    if (counters.queued == 0)
+        trimTimer->start();
+
+    if (!ok) {
+        counters.dropped++;
+        qWarning() << "Frame grab failed:" << path << error;
+        return;
+    }
+
+    counters.saved++;
+    latencyRing.add((clock.nsecsElapsed() - issuedNs) / 1000);
+    emit frameSaved(path);
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QObject>
+#include <QQueue>
+#include <QString>
+#include <QThreadPool>
+#include <QTimer>
+#include <mutex>
+#include <mpv/client.h>
+#include "framestats.h"
+
+// Reused pixel buffers for grabbed frames. mpv's screenshot-raw result is
+// copied into a free one on the event thread, so neither mpv's reply nor the
+// GUI thread holds on to the pixels; encoders hand buffers back when done.
+class FramePool
+{
+public:
+    static constexpr int kSlots = 6;
+
+    // Event thread: copies a screenshot-raw result; -1 when unusable or all
+    // buffers are taken
+    int store(const mpv_node *result);
+
+    // Wraps the buffer without copying; valid until release(slot)
+    QImage image(int slot) const;
+    void release(int slot);
+
+    // Frees the memory of buffers not in use
+    void trim();
+    qint64 bytesAllocated() const;
+
+    // Buffers together stay under `bytes` (-1: no limit), though one frame
+    // always fits; free buffers over it are released straight away
+    void setLimit(qint64 bytes);
+    // Size of the last frame stored, 0 before the first
+    qint64 lastFrameBytes() const;
+
+private:
+    struct Slot
+    {
+        QByteArray buffer;
+        QImage image;
+        bool busy = false;
+    };
+
+    qint64 allocatedLocked() const;
+    void trimLocked(qint64 keep);
+
+    mutable std::mutex mutex;
+    Slot buffers[kSlots];
+    qint64 limit = -1;
+    qint64 lastSize = 0;
+};
+
+// Saves the frame on screen at source resolution without blocking the GUI or
+// playback: screenshot-raw runs as an async command, its pixels land in the
+// pool and PNG, JPEG or WebP encoding runs on a small thread pool. Bursts
+// grab a number of frames at a fixed interval.
+class FrameGrabber : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FrameGrabber(QObject *parent = nullptr);
+    ~FrameGrabber() override;
+
+    void setHandle(mpv_handle *handle) { mpv = handle; }
+    FramePool *pool() { return &framePool; }
+    void setMemoryLimit(qint64 bytes) { memoryLimit = bytes; framePool.setLimit(bytes); }
+
+    void setDirectory(const QString &path) { directory = path; }
+    // "png", "jpg" or "webp"; false when Qt has no writer for it
+    bool setFormat(const QString &format);
+
+    // Files are named baseName-N.ext; false when too many grabs are in flight
+    // or another frame would not fit in the memory limit
+    bool capture(const QString &baseName);
+    void captureBurst(const QString &baseName, int count, int intervalMs);
+
+    // Fed from MpvWidget's event processing; slot is where the pixels went
+    void commandReply(int error, int slot);
+
+    struct Stats
+    {
+        int queued = 0;          // requested and not yet on disk
+        int peakQueued = 0;
+        quint64 saved = 0;
+        quint64 dropped = 0;     // grabs refused or lost while the queue was full
+    };
+    Stats stats() const { return counters; }
+
+    // Time from the request to the file being written (us)
+    const FrameTimeRing &latency() const { return latencyRing; }
+
+signals:
+    void frameSaved(const QString &path);
+
+private:
+    struct Request
+    {
+        QString path;
+        qint64 issuedNs = 0;
+    };
+
+    void finish(bool ok, const QString &path, qint64 issuedNs, const QString &error);
+
+    mpv_handle *mpv = nullptr;
+    FramePool framePool;
+    QThreadPool encoders;
+    QElapsedTimer clock;
+    QQueue<Request> requests;   // in mpv's reply order
+    QString directory;
+    QByteArray format = "png";
+    qint64 memoryLimit = -1;
+    quint64 sequence = 0;
+
+    QTimer *burstTimer;
+    QString burstName;
+    int burstRemaining = 0;
+    QTimer *trimTimer;
+
+    Stats counters;
+    FrameTimeRing latencyRing;
+};
@@ -0,0 +1,27 @@
+#include "framestats.h"
+#include <algorithm>
+#include <cmath>
+
+qint64 FrameTimeRing::percentile(double p) const
+{
+    if (filled == 0)
+        return 0;
+
+    std::array<qint64, Capacity> scratch;
+    std::copy(samples.begin(), samples.begin() + filled, scratch.begin());
+
+    int rank = static_cast<int>(std::ceil(qBound(0.0, p, 1.0) * filled)) - 1;
+    rank = qBound(0, rank, filled - 1);
+    std::nth_element(scratch.begin(), scratch.begin() + rank, scratch.begin() + filled);
+    return scratch[rank];
+}
+
+QVector<qint64> FrameTimeRing::history(int maxCount) const
+{
+    const int n = qMin(maxCount, filled);
+    QVector<qint64> out;
+    out.reserve(n);
+    for (int i = n; i > 0; --i)
+        out.append(samples[(head + Capacity - i) % Capacity]);
+    return out;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QtGlobal>
+#include <QVector>
+#include <array>
+
+// Fixed-size ring of timing samples (microseconds). Adding a sample never
+// allocates; percentiles are computed on demand from a scratch copy.
+class FrameTimeRing
+{
+public:
+    static constexpr int Capacity = 600;
+
+    void add(qint64 us)
+    {
+        samples[head] = us;
+        head = (head + 1) % Capacity;
+        if (filled < Capacity)
+            filled++;
+    }
+
+    void clear() { head = 0; filled = 0; }
+    int count() const { return filled; }
+    qint64 last() const { return filled ? samples[(head + Capacity - 1) % Capacity] : 0; }
+
+    // p in [0, 1]; returns 0 when empty
+    qint64 percentile(double p) const;
+
+    // Samples ordered oldest to newest, at most maxCount of the newest ones
+    QVector<qint64> history(int maxCount = Capacity) const;
+
+private:
+    std::array<qint64, Capacity> samples{};
+    int head = 0;
+    int filled = 0;
+};
+
+// Per-frame timings recorded by the video backend as it presents a frame:
+// GLVideoBackend::renderSurface before the swap, SwVideoBackend::present
+// when a frame rendered on its thread is handed to the widget
+struct FrameStats
+{
+    FrameTimeRing renderTime;     // time spent in mpv_render_context_render
+    FrameTimeRing frameInterval;  // gap between consecutive paints
+    quint64 framesRendered = 0;
+    qint64 lastPaintNs = -1;
+
+    void recordFrame(qint64 startNs, qint64 endNs)
+    {
+        renderTime.add((endNs - startNs) / 1000);
+        if (lastPaintNs >= 0)
+            frameInterval.add((startNs - lastPaintNs) / 1000);
+        lastPaintNs = startNs;
+        framesRendered++;
+    }
+
+    void reset()
+    {
+        renderTime.clear();
+        frameInterval.clear();
+        framesRendered = 0;
+        lastPaintNs = -1;
+    }
+};
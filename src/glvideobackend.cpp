@@ -0,0 +1,262 @@
+#include "glvideobackend.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QEvent>
+#include <QOpenGLContext>
+#include <QOpenGLWidget>
+#include <QOpenGLWindow>
+
+// Composited surface: Qt renders into an FBO and blends it into the window
+class GLVideoWidget : public QOpenGLWidget
+{
+public:
+    GLVideoWidget(GLVideoBackend *backend, QWidget *parent)
+        : QOpenGLWidget(parent), backend(backend)
+    {
+        // Unhandled input propagates to MpvWidget
+        setMouseTracking(true);
+    }
+
+protected:
+    void initializeGL() override { backend->initializeSurface(); }
+
+    void paintGL() override
+    {
+        const qreal dpr = devicePixelRatio();
+        backend->renderSurface(static_cast<int>(defaultFramebufferObject()),
+                               static_cast<int>(dpr * width()), static_cast<int>(dpr * height()));
+    }
+
+private:
+    GLVideoBackend *backend;
+};
+
+// Direct surface: a native window whose default framebuffer mpv draws into.
+// Native windows swallow their own input, so it is handed on to the host.
+class GLVideoWindow : public QOpenGLWindow
+{
+public:
+    GLVideoWindow(GLVideoBackend *backend, QWidget *host)
+        : QOpenGLWindow(QOpenGLWindow::NoPartialUpdate), backend(backend), host(host)
+    {
+    }
+
+protected:
+    void initializeGL() override { backend->initializeSurface(); }
+
+    void paintGL() override
+    {
+        const qreal dpr = devicePixelRatio();
+        backend->renderSurface(static_cast<int>(defaultFramebufferObject()),
+                               static_cast<int>(dpr * width()), static_cast<int>(dpr * height()));
+    }
+
+    bool event(QEvent *event) override
+    {
+        switch (event->type()) {
+        case QEvent::MouseMove:
+        case QEvent::MouseButtonPress:
+        case QEvent::MouseButtonRelease:
+        case QEvent::MouseButtonDblClick:
+        case QEvent::Wheel:
+        case QEvent::KeyPress:
+        case QEvent::KeyRelease:
+        case QEvent::Enter:
+        case QEvent::Leave:
+        case QEvent::DragEnter:
+        case QEvent::DragMove:
+        case QEvent::DragLeave:
+        case QEvent::Drop:
+            // The container fills the host, so positions need no mapping
+            return QCoreApplication::sendEvent(host, event);
+        default:
+            return QOpenGLWindow::event(event);
+        }
+    }
+
+private:
+    GLVideoBackend *backend;
+    QWidget *host;
+};
+
+// Cursor changes on the host have to reach the native window as well
+class CursorForwarder : public QObject
+{
+public:
+    CursorForwarder(QWidget *host, QWindow *window) : QObject(host), window(window)
+    {
+        host->installEventFilter(this);
+    }
+
+protected:
+    bool eventFilter(QObject *obj, QEvent *event) override
+    {
+        if (event->type() == QEvent::CursorChange)
+            window->setCursor(static_cast<QWidget *>(obj)->cursor());
+        return QObject::eventFilter(obj, event);
+    }
+
+private:
+    QWindow *window;
+};
+
+GLVideoBackend::GLVideoBackend(bool direct, QWidget *host)
+    : VideoBackend(host), direct(direct)
+{
+    if (direct) {
+        glWindow = new GLVideoWindow(this, host);
+        surface = QWidget::createWindowContainer(glWindow, host);
+        surface->setFocusPolicy(Qt::NoFocus);
+        new CursorForwarder(host, glWindow);
+        connect(glWindow, &QOpenGLWindow::frameSwapped, this, &GLVideoBackend::reportSwap);
+    } else {
+        glWidget = new GLVideoWidget(this, host);
+        surface = glWidget;
+        connect(glWidget, &QOpenGLWidget::frameSwapped, this, &GLVideoBackend::reportSwap);
+    }
+}
+
+GLVideoBackend::~GLVideoBackend()
+{
+    detach();
+}
+
+void GLVideoBackend::attach(mpv_handle *handle)
+{
+    mpv = handle;
+    if (surfaceReady && !renderContext) {
+        makeCurrent();
+        createRenderContext();
+        doneCurrent();
+    }
+}
+
+void GLVideoBackend::detach()
+{
+    if (!renderContext)
+        return;
+
+    // mpv frees its GL objects here, so the surface's context must be current
+    makeCurrent();
+    mpv_render_context_free(renderContext);
+    renderContext = nullptr;
+    doneCurrent();
+}
+
+void GLVideoBackend::initializeSurface()
+{
+    surfaceReady = true;
+    if (mpv && !renderContext)
+        createRenderContext();
+}
+
+void GLVideoBackend::createRenderContext()
+{
+    mpv_opengl_init_params gl_init = {
+        .get_proc_address = [](void *, const char *name) -> void * {
+            return reinterpret_cast<void *>(QOpenGLContext::currentContext()->getProcAddress(name));
+        },
+        .get_proc_address_ctx = nullptr
+    };
+
+    mpv_render_param params[] = {
+        {MPV_RENDER_PARAM_API_TYPE, const_cast<char*>(MPV_RENDER_API_TYPE_OPENGL)},
+        {MPV_RENDER_PARAM_OPENGL_INIT_PARAMS, &gl_init},
+        {MPV_RENDER_PARAM_INVALID, nullptr}
+    };
+
+    if (mpv_render_context_create(&renderContext, mpv, params) < 0) {
+        qWarning() << "Failed to create MPV OpenGL render context";
+        renderContext = nullptr;
+        emit failed();
+        return;
+    }
+
+    mpv_render_context_set_update_callback(renderContext, onUpdate, this);
+
+    // The surface may have painted black before mpv was there
+    redraw();
+    emit attached();
+}
+
+void GLVideoBackend::renderSurface(int fbo, int width, int height)
+{
+    if (!renderContext)
+        return;
+
+    mpv_opengl_fbo target = {
+        .fbo = fbo,
+        .w   = width,
+        .h   = height,
+        .internal_format = 0,
+    };
+
+    int flip_y = 1;
+
+    mpv_render_param params[] = {
+        {MPV_RENDER_PARAM_OPENGL_FBO, &target},
+        {MPV_RENDER_PARAM_FLIP_Y, &flip_y},
+        {MPV_RENDER_PARAM_INVALID, nullptr}
+    };
+
+    if (!frameStats) {
+        mpv_render_context_render(renderContext, params);
+    } else {
+        const qint64 start = clock.nsecsElapsed();
+        mpv_render_context_render(renderContext, params);
+        frameStats->recordFrame(start, clock.nsecsElapsed());
+    }
+
+    emit framePresented();
+}
+
+// Runs on an mpv thread: no widget calls here, and at most one check queued
+void GLVideoBackend::onUpdate(void *ctx)
+{
+    auto *self = static_cast<GLVideoBackend *>(ctx);
+    if (self->deferRedraw())
+        return;
+    if (!self->updateQueued.exchange(true))
+        QMetaObject::invokeMethod(self, &GLVideoBackend::processUpdate, Qt::QueuedConnection);
+}
+
+void GLVideoBackend::processUpdate()
+{
+    updateQueued = false;
+    if (!renderContext)
+        return;
+
+    // mpv also calls back for work that needs no new frame on screen
+    if (mpv_render_context_update(renderContext) & MPV_RENDER_UPDATE_FRAME)
+        redraw();
+}
+
+void GLVideoBackend::reportSwap()
+{
+    if (renderContext)
+        mpv_render_context_report_swap(renderContext);
+}
+
+void GLVideoBackend::redraw()
+{
+    if (glWindow)
+        glWindow->update();
+    else
+        glWidget->update();
+}
+
+void GLVideoBackend::makeCurrent()
+{
+    if (glWindow)
+        glWindow->makeCurrent();
+    else
+        glWidget->makeCurrent();
+}
+
+void GLVideoBackend::doneCurrent()
+{
+    if (glWindow)
+        glWindow->doneCurrent();
+    else
+        glWidget->doneCurrent();
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <atomic>
+#include <mpv/render_gl.h>
+#include "videobackend.h"
+
+class GLVideoWidget;
+class GLVideoWindow;
+
+// mpv's OpenGL render API on either surface. Composited mode draws into the
+// QOpenGLWidget's FBO, which Qt then copies into the window; direct mode draws
+// into a QOpenGLWindow's own framebuffer and skips that copy. The direct
+// surface is a native child, so anything stacked above it must be native too.
+// mpv's update callback only queues one check on the GUI thread; a repaint
+// follows when mpv has a new frame, and every buffer swap is reported back so
+// mpv can pace against the display.
+class GLVideoBackend : public VideoBackend
+{
+    Q_OBJECT
+
+public:
+    GLVideoBackend(bool direct, QWidget *host);
+    ~GLVideoBackend() override;
+
+    Mode mode() const override { return direct ? Direct : Composited; }
+    QWidget *widget() const override { return surface; }
+
+    void attach(mpv_handle *handle) override;
+    void detach() override;
+    bool isAttached() const override { return renderContext != nullptr; }
+    void redraw() override;
+
+    // Called by the surfaces with their GL context current
+    void initializeSurface();
+    void renderSurface(int fbo, int width, int height);
+
+private slots:
+    void processUpdate();
+    void reportSwap();
+
+private:
+    static void onUpdate(void *ctx);
+    void createRenderContext();
+    void makeCurrent();
+    void doneCurrent();
+
+    bool direct;
+    GLVideoWidget *glWidget = nullptr;
+    GLVideoWindow *glWindow = nullptr;
+    QWidget *surface = nullptr;   // glWidget, or the container around glWindow
+
+    mpv_handle *mpv = nullptr;
+    mpv_render_context *renderContext = nullptr;
+    bool surfaceReady = false;
+    std::atomic<bool> updateQueued{false};
+};
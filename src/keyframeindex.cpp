@@ -0,0 +1,238 @@
+#include "keyframeindex.h"
+#include "mpvcore.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <algorithm>
+
+// Times this close are the same keyframe reported twice
+static constexpr double kSameKeyframeSeconds = 0.001;
+// Results go out in batches so scrubbing can use a partial index
+static constexpr int kBatchSize = 256;
+static constexpr qint64 kBatchMs = 500;
+static constexpr int kStepTimeoutMs = 3000;
+
+// Observe ids of the indexer's own instance
+static constexpr quint64 kObserveTimePos = 1;
+static constexpr quint64 kObserveEof = 2;
+
+void KeyframeIndex::add(const QList<double> &times)
+{
+    if (times.isEmpty())
+        return;
+
+    keys += times;
+    std::sort(keys.begin(), keys.end());
+    auto last = std::unique(keys.begin(), keys.end(), [](double a, double b) {
+        return b - a < kSameKeyframeSeconds;
+    });
+    keys.erase(last, keys.end());
+    thin();
+}
+
+void KeyframeIndex::setCapacity(int count)
+{
+    capacity = count;
+    thin();
+}
+
+void KeyframeIndex::thin()
+{
+    if (capacity < 0)
+        return;
+
+    while (keys.size() > qMax(1, capacity)) {
+        qsizetype kept = 0;
+        for (qsizetype i = 0; i < keys.size(); i += 2)
+            keys[kept++] = keys[i];
+        keys.resize(kept);
+    }
+}
+
+double KeyframeIndex::atOrBefore(double seconds) const
+{
+    auto it = std::upper_bound(keys.cbegin(), keys.cend(), seconds + kSameKeyframeSeconds);
+    return it == keys.cbegin() ? -1 : *(it - 1);
+}
+
+double KeyframeIndex::after(double seconds) const
+{
+    auto it = std::upper_bound(keys.cbegin(), keys.cend(), seconds + kSameKeyframeSeconds);
+    return it == keys.cend() ? -1 : *it;
+}
+
+KeyframeIndexer::KeyframeIndexer(QObject *parent)
+: QThread(parent)
+{
+    setObjectName("keyframe-index");
+}
+
+KeyframeIndexer::~KeyframeIndexer()
+{
+    stop();
+}
+
+void KeyframeIndexer::index(const QString &path, quint64 generation)
+{
+    QMutexLocker lock(&mutex);
+    pending.generation = generation;
+    pending.path = path;
+    hasJob = !path.isEmpty();
+    wakeup.wakeOne();
+}
+
+void KeyframeIndexer::stop()
+{
+    {
+        QMutexLocker lock(&mutex);
+        stopping = true;
+        hasJob = false;
+        wakeup.wakeOne();
+    }
+    wait();
+}
+
+bool KeyframeIndexer::takeJob(Job &job)
+{
+    QMutexLocker lock(&mutex);
+    while (!hasJob && !stopping)
+        wakeup.wait(&mutex);
+
+    if (stopping)
+        return false;
+
+    job = pending;
+    hasJob = false;
+    return true;
+}
+
+bool KeyframeIndexer::interrupted()
+{
+    // A newer file, or none at all, replaces the current walk
+    QMutexLocker lock(&mutex);
+    return stopping || hasJob || pending.path.isEmpty();
+}
+
+void KeyframeIndexer::run()
+{
+    // Nothing is shown: frames only go as far as the null output, as fast as
+    // the decoder produces them, and the decoder drops all but keyframes
+    mpv = createSecondaryMpv("Keyframe index", {
+        {"vo", "null"},
+        {"untimed", "yes"},
+        {"aid", "no"},
+        {"sid", "no"},
+        {"audio-display", "no"},
+        {"hwdec", "no"},
+        {"pause", "yes"},
+        {"keep-open", "yes"},
+        {"vd-lavc-skipframe", "nonkey"},
+        {"vd-lavc-skiploopfilter", "all"},
+        {"vd-lavc-fast", "yes"},
+        {"vd-lavc-threads", "1"},
+        {"cache", "no"},
+        {"demuxer-readahead-secs", "0"},
+    });
+    if (!mpv)
+        return;
+
+    mpv_observe_property(mpv, kObserveTimePos, "time-pos", MPV_FORMAT_DOUBLE);
+    mpv_observe_property(mpv, kObserveEof, "eof-reached", MPV_FORMAT_FLAG);
+
+    Job job;
+    while (takeJob(job))
+        walk(job);
+
+    mpv_destroy(mpv);
+    mpv = nullptr;
+}
+
+void KeyframeIndexer::walk(const Job &job)
+{
+    const QByteArray file = job.path.toUtf8();
+    const char *load[] = {"loadfile", file.constData(), nullptr};
+    if (mpv_command(mpv, load) < 0 || !waitForEvent(MPV_EVENT_FILE_LOADED, 5000))
+        return;
+
+    QList<double> batch;
+    double last = -1;
+    bool eof = false;
+
+    // Paused on the first keyframe once it is decoded
+    if (waitForEvent(MPV_EVENT_PLAYBACK_RESTART, 5000)) {
+        if (mpv_get_property(mpv, "time-pos", MPV_FORMAT_DOUBLE, &last) >= 0)
+            batch.append(last);
+
+        // Notifications from loading would pass for step results
+        while (mpv_wait_event(mpv, 0)->event_id != MPV_EVENT_NONE) {
+        }
+
+        // With only keyframes decoded, each step lands on the next one
+        QElapsedTimer sinceEmit;
+        sinceEmit.start();
+        while (!interrupted()) {
+            const char *step[] = {"frame-step", nullptr};
+            double seconds = -1;
+            if (mpv_command(mpv, step) < 0 || !waitForStep(&seconds, &eof) || eof)
+                break;
+
+            if (seconds > last) {
+                batch.append(seconds);
+                last = seconds;
+            }
+            if (batch.size() >= kBatchSize || sinceEmit.elapsed() >= kBatchMs) {
+                emit keyframesFound(job.generation, batch, false);
+                batch.clear();
+                sinceEmit.restart();
+            }
+        }
+    }
+
+    if (!batch.isEmpty() || eof)
+        emit keyframesFound(job.generation, batch, eof);
+
+    const char *unload[] = {"stop", nullptr};
+    mpv_command(mpv, unload);
+}
+
+bool KeyframeIndexer::waitForEvent(mpv_event_id id, int timeoutMs)
+{
+    return waitForMpvEvent(mpv, id, timeoutMs, [this]() { return interrupted(); });
+}
+
+bool KeyframeIndexer::waitForStep(double *seconds, bool *eof)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    while (timer.elapsed() < kStepTimeoutMs) {
+        if (interrupted())
+            return false;
+
+        mpv_event *event = mpv_wait_event(mpv, 0.05);
+        switch (event->event_id) {
+        case MPV_EVENT_PROPERTY_CHANGE: {
+            const auto *prop = static_cast<const mpv_event_property *>(event->data);
+            if (!prop->data)
+                break;
+            if (event->reply_userdata == kObserveTimePos) {
+                *seconds = *static_cast<double *>(prop->data);
+                return true;
+            }
+            if (event->reply_userdata == kObserveEof && *static_cast<int *>(prop->data)) {
+                *eof = true;
+                return true;
+            }
+            break;
+        }
+        case MPV_EVENT_END_FILE:
+            *eof = true;
+            return true;
+        case MPV_EVENT_SHUTDOWN:
+            return false;
+        default:
+            break;
+        }
+    }
+    return false;
+}
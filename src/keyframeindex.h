@@ -0,0 +1,83 @@
+#pragma once
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+#include <mpv/client.h>
+
+// Sorted keyframe times of one file
+class KeyframeIndex
+{
+public:
+    void clear() { keys.clear(); complete = false; }
+    void add(const QList<double> &times);
+
+    // Over `count` keyframes (-1: no limit) every other one is dropped, so
+    // the whole file stays covered at a coarser spacing
+    void setCapacity(int count);
+
+    bool isEmpty() const { return keys.isEmpty(); }
+    int size() const { return keys.size(); }
+    const QList<double> &times() const { return keys; }
+
+    // Every keyframe of the file is in, not just those seen so far
+    bool isComplete() const { return complete; }
+    void setComplete(bool done) { complete = done; }
+
+    // Last keyframe at or before `seconds`; -1 when there is none
+    double atOrBefore(double seconds) const;
+    // First keyframe after `seconds`; -1 when there is none
+    double after(double seconds) const;
+
+private:
+    void thin();
+
+    QList<double> keys;
+    bool complete = false;
+    int capacity = -1;
+};
+
+// Walks a file keyframe by keyframe in a secondary, video-only mpv instance
+// that decodes nothing but keyframes, and reports their times in batches.
+// Runs at idle priority; a new file replaces the one being indexed.
+class KeyframeIndexer : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit KeyframeIndexer(QObject *parent = nullptr);
+    ~KeyframeIndexer() override;
+
+    // Local path, or empty to just abandon the current file
+    void index(const QString &path, quint64 generation);
+    void stop();
+
+signals:
+    void keyframesFound(quint64 generation, const QList<double> &times, bool finished);
+
+protected:
+    void run() override;
+
+private:
+    struct Job
+    {
+        quint64 generation = 0;
+        QString path;
+    };
+
+    bool takeJob(Job &job);
+    bool interrupted();
+    bool waitForEvent(mpv_event_id id, int timeoutMs);
+    bool waitForStep(double *seconds, bool *eof);
+    void walk(const Job &job);
+
+    QMutex mutex;
+    QWaitCondition wakeup;
+    Job pending;
+    bool hasJob = false;
+    bool stopping = false;
+
+    // Owned by the worker thread
+    mpv_handle *mpv = nullptr;
+};
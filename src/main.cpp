@@ -8,25 +8,94 @@
 #include <QKeySequence>
 #include <QInputDialog>
 #include <QDir>
+#include <QStandardPaths>
+#include <QCommandLineParser>
+#include <QDebug>
+#include "controlserver.h"
 #include "mpvwidget.h"
+#include "startuptrace.h"
+#include "videowall.h"
 
 
 int main(int argc, char *argv[])
 {
+    StartupTrace::begin();
+
     QApplication app(argc, argv);
 
     Q_INIT_RESOURCE(resources);
 
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addPositionalArgument("file", "Files, folders, playlists or URLs to play (tiled with --wall).");
+    QCommandLineOption startupTraceOpt("startup-trace", "Print startup phase timings once the first frame is shown.");
+    parser.addOption(startupTraceOpt);
+    QCommandLineOption renderModeOpt("render-mode", "Video output: composited (default), direct or software.", "mode", "composited");
+    parser.addOption(renderModeOpt);
+    QCommandLineOption wallOpt("wall", "Show every file or URL given at once, in a grid.");
+    parser.addOption(wallOpt);
+    QCommandLineOption controlSocketOpt("control-socket", "Accept remote control commands on this local socket.", "name");
+    parser.addOption(controlSocketOpt);
+    QCommandLineOption audioOnlyOpt("audio-only", "Play sound only, without a video output (A toggles).");
+    parser.addOption(audioOnlyOpt);
+    QCommandLineOption captureDirOpt("capture-dir", "Save grabbed frames here (default: the pictures folder).", "dir");
+    parser.addOption(captureDirOpt);
+    QCommandLineOption captureFormatOpt("capture-format", "Image format for grabbed frames: png (default), jpg or webp.", "format", "png");
+    parser.addOption(captureFormatOpt);
+    QCommandLineOption memoryBudgetOpt("memory-budget", "Memory for caches, thumbnails and metadata, in MiB (default: no limit).", "mib");
+    parser.addOption(memoryBudgetOpt);
+    parser.process(app);
+
+    // Monitoring wall: all streams in one window, no player controls
+    if (parser.isSet(wallOpt)) {
+        QMainWindow wallWindow;
+        wallWindow.setWindowTitle("MPV Player - Wall");
+        wallWindow.resize(1280, 720);
+
+        VideoWall *wall = new VideoWall(&wallWindow);
+        wallWindow.setCentralWidget(wall);
+        wall->setSources(parser.positionalArguments());
+
+        wallWindow.show();
+        return app.exec();
+    }
+
+    VideoBackend::Mode renderMode = VideoBackend::Composited;
+    if (!VideoBackend::parseMode(parser.value(renderModeOpt), &renderMode))
+        qWarning() << "Unknown render mode" << parser.value(renderModeOpt) << "- using composited";
+
+    StartupTrace::setPrintOnFirstFrame(parser.isSet(startupTraceOpt));
+
     QMainWindow mainWindow;
     mainWindow.setWindowTitle("MPV Player - INNA Style");
     mainWindow.resize(1280, 720);
 
-    MpvWidget *mpvWidget = new MpvWidget(&mainWindow);
+    MpvWidget *mpvWidget = new MpvWidget(&mainWindow, renderMode);
     mainWindow.setCentralWidget(mpvWidget);
+    mpvWidget->setPlaylistFile(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/playlist.bin");
+
+    CacheProfiles cacheProfiles;
+    cacheProfiles.diskCacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/stream-cache";
+    cacheProfiles.load(QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation) + "/cache-profiles.json");
+    mpvWidget->setCacheProfiles(cacheProfiles);
+    mpvWidget->setProbeCacheFile(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/probe-cache.bin");
+    mpvWidget->setAudioOnly(parser.isSet(audioOnlyOpt));
+    if (parser.isSet(captureDirOpt))
+        mpvWidget->frameGrabber()->setDirectory(parser.value(captureDirOpt));
+    mpvWidget->frameGrabber()->setFormat(parser.value(captureFormatOpt));
+    if (parser.isSet(memoryBudgetOpt))
+        mpvWidget->setMemoryBudget(parser.value(memoryBudgetOpt).toLongLong() * 1024 * 1024);
+
+    if (parser.isSet(controlSocketOpt)) {
+        auto *controlServer = new ControlServer(mpvWidget, mpvWidget);
+        if (controlServer->listen(parser.value(controlSocketOpt)))
+            qInfo() << "Control socket:" << controlServer->serverPath();
+    }
 
     mainWindow.show();
     mainWindow.raise();
     mainWindow.activateWindow();
+    StartupTrace::mark(StartupTrace::WindowShown);
 
     mainWindow.setStyleSheet(R"(
         QMainWindow {
@@ -61,15 +130,29 @@ int main(int argc, char *argv[])
     fileMenu->addAction(openAction);
 
     QObject::connect(openAction, &QAction::triggered, [&]() {
-        QString fileName = QFileDialog::getOpenFileName(
+        QStringList fileNames = QFileDialog::getOpenFileNames(
             &mainWindow,
-            "Open Video File",
+            "Open Files",
             QDir::homePath(),
-            "Video Files (*.mp4 *.mkv *.avi *.mov *.webm *.flv *.wmv *.m4v *.mpg *.mpeg *.ts);;All Files (*)"
+            "Media Files (*.mp4 *.mkv *.avi *.mov *.webm *.flv *.wmv *.m4v *.mpg *.mpeg *.ts"
+            " *.mp3 *.flac *.ogg *.opus *.m4a *.wav *.m3u *.m3u8 *.pls);;All Files (*)"
         );
 
-        if (!fileName.isEmpty()) {
-            mpvWidget->play(fileName);
+        if (!fileNames.isEmpty()) {
+            mpvWidget->open(fileNames);
+        }
+    });
+
+    // Open folder action: everything playable below it, in the background
+    QAction *openFolderAction = new QAction("Open Folder...", &mainWindow);
+    openFolderAction->setShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_O));
+    fileMenu->addAction(openFolderAction);
+
+    QObject::connect(openFolderAction, &QAction::triggered, [&]() {
+        QString dir = QFileDialog::getExistingDirectory(&mainWindow, "Open Folder", QDir::homePath());
+
+        if (!dir.isEmpty()) {
+            mpvWidget->open({dir});
         }
     });
 
@@ -105,9 +188,8 @@ int main(int argc, char *argv[])
     mainWindow.show();
 
     // Only auto-play when a file/URL is provided via CLI; otherwise start idle/black
-    if (argc > 1) {
-        QString videoPath = QString::fromUtf8(argv[1]);
-        mpvWidget->play(videoPath);
+    if (!parser.positionalArguments().isEmpty()) {
+        mpvWidget->open(parser.positionalArguments());
     }
 
     return app.exec();
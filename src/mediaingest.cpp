@@ -0,0 +1,389 @@
+#include "mediaingest.h"
+#include "mpveventthread.h"
+#include "playerstate.h"
+#include "mpvcore.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <QUrl>
+
+// Entries handed to the GUI at a time; each batch is one playlist append
+static constexpr int kBatchSize = 256;
+// Listing is mostly waiting on the disk; a few threads keep it busy
+static constexpr int kMaxIngestThreads = 4;
+// Probing is opening files, so it is bounded the same way
+static constexpr int kMaxProbeThreads = 4;
+
+static bool isRemote(const QString &input)
+{
+    return input.contains("://") && !input.startsWith("file://");
+}
+
+static QString localPath(const QString &input)
+{
+    return input.startsWith("file://") ? QUrl(input).toLocalFile() : input;
+}
+
+// Collects one task's entries and hands them over in batches
+class MediaIngest::Batch
+{
+public:
+    Batch(MediaIngest *owner, quint64 request) : request(request), owner(owner) {}
+    ~Batch() { flush(); }
+
+    void add(const QString &url)
+    {
+        urls.append(url);
+        if (urls.size() >= kBatchSize)
+            flush();
+    }
+
+    void flush()
+    {
+        if (urls.isEmpty())
+            return;
+        owner->deliver(request, urls);
+        urls.clear();
+    }
+
+    const quint64 request;
+
+private:
+    MediaIngest *owner;
+    QStringList urls;
+};
+
+MediaIngest::MediaIngest(QObject *parent)
+: QObject(parent)
+{
+    pool.setMaxThreadCount(qBound(1, QThread::idealThreadCount() / 2, kMaxIngestThreads));
+}
+
+MediaIngest::~MediaIngest()
+{
+    stopping.store(true);
+    pool.clear();
+    pool.waitForDone();
+}
+
+quint64 MediaIngest::add(const QStringList &inputs)
+{
+    const quint64 request = ++nextRequest;
+    if (pendingTasks.load() == 0)
+        clock.start();
+
+    // Streams need no looking at; everything local is looked at off the GUI
+    // thread, even whether it is a directory
+    QStringList remote;
+    QStringList local;
+    for (const QString &input : inputs) {
+        if (input.isEmpty())
+            continue;
+        if (isRemote(input))
+            remote << input;
+        else
+            local << localPath(input);
+    }
+
+    if (!remote.isEmpty())
+        deliver(request, remote);
+    if (!local.isEmpty())
+        start(request, [this, local](Batch &batch) { addFiles(batch, local, true); });
+    return request;
+}
+
+void MediaIngest::start(quint64 request, std::function<void(Batch &)> task)
+{
+    pendingTasks.fetch_add(1);
+    pool.start([this, request, task]() {
+        if (!stopping.load()) {
+            Batch batch(this, request);
+            task(batch);
+        }
+        taskDone();
+    });
+}
+
+void MediaIngest::addFiles(Batch &batch, const QStringList &paths, bool explicitFiles)
+{
+    for (const QString &path : paths) {
+        if (stopping.load())
+            return;
+
+        const QFileInfo info(path);
+        if (info.isDir()) {
+            const QString dir = info.absoluteFilePath();
+            start(batch.request, [this, dir](Batch &b) { listDirectory(b, dir); });
+            continue;
+        }
+        if (!info.isFile())
+            continue;
+
+        filesSeen.fetch_add(1, std::memory_order_relaxed);
+        const QString suffix = info.suffix().toLower();
+        if (explicitFiles && (suffix == "m3u" || suffix == "m3u8" || suffix == "pls")) {
+            readPlaylist(batch, info.absoluteFilePath());
+            continue;
+        }
+        if (isMedia(info.absoluteFilePath(), explicitFiles))
+            batch.add(info.absoluteFilePath());
+    }
+}
+
+void MediaIngest::listDirectory(Batch &batch, const QString &path)
+{
+    directories.fetch_add(1, std::memory_order_relaxed);
+
+    QStringList files;
+    QStringList subdirs;
+    const QFileInfoList children = QDir(path).entryInfoList(
+        QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::Readable, QDir::Name | QDir::IgnoreCase);
+    for (const QFileInfo &child : children) {
+        // Linked directories can loop back up the tree
+        if (child.isDir()) {
+            if (!child.isSymLink())
+                subdirs << child.absoluteFilePath();
+        } else {
+            files << child.absoluteFilePath();
+        }
+    }
+
+    // A directory's own files go in before anything below it
+    addFiles(batch, files, false);
+    batch.flush();
+
+    for (const QString &dir : std::as_const(subdirs))
+        start(batch.request, [this, dir](Batch &b) { listDirectory(b, dir); });
+}
+
+void MediaIngest::readPlaylist(Batch &batch, const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qWarning() << "Could not read playlist" << path;
+        return;
+    }
+
+    QStringList lines;
+    QTextStream in(&file);
+    while (!in.atEnd())
+        lines << in.readLine().trimmed();
+
+    const bool pls = path.endsWith(".pls", Qt::CaseInsensitive);
+
+    // HLS playlists describe one stream; mpv plays the file itself
+    if (!pls) {
+        for (const QString &line : std::as_const(lines)) {
+            if (line.startsWith("#EXT-X-")) {
+                batch.add(path);
+                return;
+            }
+        }
+    }
+
+    // Entries are not sniffed: whoever wrote the list meant them
+    const QDir base = QFileInfo(path).absoluteDir();
+    for (const QString &line : std::as_const(lines)) {
+        QString entry;
+        if (pls) {
+            const int eq = line.indexOf('=');
+            if (!line.startsWith("File", Qt::CaseInsensitive) || eq < 0)
+                continue;
+            entry = line.mid(eq + 1).trimmed();
+        } else {
+            if (line.isEmpty() || line.startsWith('#'))
+                continue;
+            entry = line;
+        }
+
+        if (isRemote(entry)) {
+            batch.add(entry);
+            continue;
+        }
+
+        const QFileInfo info(base, QDir::fromNativeSeparators(localPath(entry)));
+        if (info.isFile())
+            batch.add(info.absoluteFilePath());
+    }
+}
+
+bool MediaIngest::isMedia(const QString &path, bool explicitFile) const
+{
+    // Playlists and cue sheets carry audio MIME types but would add their
+    // entries a second time
+    static const QStringList lists = {
+        "audio/x-mpegurl", "audio/mpegurl", "application/vnd.apple.mpegurl", "application/x-mpegurl",
+        "audio/x-scpls", "audio/x-ms-asx", "application/x-cue",
+    };
+    static const QStringList containers = {
+        "application/ogg", "application/x-ogg", "application/vnd.rn-realmedia", "application/mxf",
+    };
+
+    // By name first; the content is read only when the name says too little
+    const QMimeType type = mimeDatabase.mimeTypeForFile(path);
+    const QString name = type.name();
+    if (lists.contains(name))
+        return false;
+    if (name.startsWith("video/") || name.startsWith("audio/") || containers.contains(name))
+        return true;
+    for (const QString &ancestor : type.allAncestors()) {
+        if (ancestor.startsWith("video/") || ancestor.startsWith("audio/"))
+            return true;
+    }
+
+    // mpv may still make sense of an unknown file picked by hand
+    return explicitFile && type.isDefault();
+}
+
+void MediaIngest::deliver(quint64 request, const QStringList &urls)
+{
+    QMetaObject::invokeMethod(this, [this, request, urls]() {
+        entries += urls.size();
+        emit entriesFound(request, urls);
+    }, Qt::QueuedConnection);
+}
+
+void MediaIngest::taskDone()
+{
+    if (pendingTasks.fetch_sub(1) != 1)
+        return;
+
+    // Queued behind every batch delivered before it
+    QMetaObject::invokeMethod(this, [this]() {
+        if (pendingTasks.load() > 0)
+            return;
+        emit finished(entries, filesSeen.exchange(0), directories.exchange(0), clock.elapsed());
+        entries = 0;
+    }, Qt::QueuedConnection);
+}
+
+MediaProber::MediaProber(QObject *parent)
+: QObject(parent)
+{
+    const int count = qBound(1, QThread::idealThreadCount() / 2, kMaxProbeThreads);
+    for (int i = 0; i < count; ++i) {
+        QThread *worker = QThread::create([this]() { work(); });
+        worker->setObjectName(QString("media-prober-%1").arg(i));
+        workers << worker;
+    }
+}
+
+MediaProber::~MediaProber()
+{
+    stop();
+    qDeleteAll(workers);
+}
+
+void MediaProber::start(QThread::Priority priority)
+{
+    for (QThread *worker : std::as_const(workers))
+        worker->start(priority);
+}
+
+void MediaProber::enqueue(const QStringList &paths)
+{
+    if (paths.isEmpty())
+        return;
+
+    QMutexLocker lock(&mutex);
+    for (const QString &path : paths)
+        queue.enqueue(path);
+    wakeup.wakeAll();
+}
+
+void MediaProber::stop()
+{
+    {
+        QMutexLocker lock(&mutex);
+        stopping = true;
+        queue.clear();
+        wakeup.wakeAll();
+    }
+    for (QThread *worker : std::as_const(workers))
+        worker->wait();
+}
+
+bool MediaProber::takePath(QString &path)
+{
+    QMutexLocker lock(&mutex);
+    while (queue.isEmpty() && !stopping)
+        wakeup.wait(&mutex);
+
+    if (stopping)
+        return false;
+
+    path = queue.dequeue();
+    return true;
+}
+
+void MediaProber::work()
+{
+    // No track selected: opening a file runs the demuxer and nothing else.
+    // Without track-auto-selection=no mpv gives up on such a file before
+    // file-loaded ("No video or audio streams selected").
+    mpv_handle *mpv = createSecondaryMpv("Media prober", {
+        {"track-auto-selection", "no"},
+        {"vo", "null"},
+        {"ao", "null"},
+        {"vid", "no"},
+        {"aid", "no"},
+        {"sid", "no"},
+        {"audio-display", "no"},
+        {"pause", "yes"},
+        {"idle", "yes"},
+        {"cache", "no"},
+        {"demuxer-readahead-secs", "0"},
+    });
+    if (!mpv)
+        return;
+
+    QString path;
+    while (takePath(path)) {
+        ProbedMedia media;
+        if (probe(mpv, path, &media))
+            emit probed(path, media);
+    }
+
+    mpv_destroy(mpv);
+}
+
+bool MediaProber::probe(mpv_handle *mpv, const QString &path, ProbedMedia *media)
+{
+    const QByteArray file = path.toUtf8();
+    const char *load[] = {"loadfile", file.constData(), nullptr};
+    if (mpv_command(mpv, load) < 0 || !waitForEvent(mpv, MPV_EVENT_FILE_LOADED, 5000))
+        return false;
+
+    mpv_get_property(mpv, "duration", MPV_FORMAT_DOUBLE, &media->duration);
+
+    mpv_node node;
+    if (mpv_get_property(mpv, "track-list", MPV_FORMAT_NODE, &node) >= 0) {
+        for (const TrackInfo &track : PlayerState::parseTrackList(mpvNodeToVariant(&node))) {
+            if (track.type == QLatin1String("video") && !track.albumart && media->videoCodec.isEmpty()) {
+                media->videoCodec = track.codec;
+                media->width = track.width;
+                media->height = track.height;
+            } else if (track.type == QLatin1String("audio") && media->audioCodec.isEmpty()) {
+                media->audioCodec = track.codec;
+            }
+        }
+        mpv_free_node_contents(&node);
+    }
+
+    // Its end-file must not be mistaken for the next file failing
+    const char *unload[] = {"stop", nullptr};
+    if (mpv_command(mpv, unload) >= 0)
+        waitForEvent(mpv, MPV_EVENT_END_FILE, 2000);
+    return true;
+}
+
+bool MediaProber::waitForEvent(mpv_handle *mpv, mpv_event_id id, int timeoutMs)
+{
+    return waitForMpvEvent(mpv, id, timeoutMs, [this]() {
+        QMutexLocker lock(&mutex);
+        return stopping;
+    });
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMimeDatabase>
+#include <QMutex>
+#include <QObject>
+#include <QQueue>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <atomic>
+#include <functional>
+#include <mpv/client.h>
+
+// Turns dropped or opened files, directories and M3U/PLS playlists into
+// playlist entries without blocking the GUI. Directories are listed
+// recursively on a small thread pool, one task per directory; files are kept
+// when their MIME type (by name, by content where the name is not enough) is
+// audio or video. Entries arrive in batches, each directory's in name order.
+class MediaIngest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MediaIngest(QObject *parent = nullptr);
+    ~MediaIngest() override;
+
+    // Returns a request id at once; entriesFound() follows with that id
+    quint64 add(const QStringList &inputs);
+    bool isBusy() const { return pendingTasks.load() > 0; }
+
+signals:
+    void entriesFound(quint64 request, const QStringList &urls);
+    // Everything queued so far has been listed
+    void finished(int entries, int filesSeen, int directories, qint64 elapsedMs);
+
+private:
+    class Batch;
+
+    void start(quint64 request, std::function<void(Batch &)> task);
+    void listDirectory(Batch &batch, const QString &path);
+    void readPlaylist(Batch &batch, const QString &path);
+    void addFiles(Batch &batch, const QStringList &paths, bool explicitFiles);
+    bool isMedia(const QString &path, bool explicitFile) const;
+    void deliver(quint64 request, const QStringList &urls);
+    void taskDone();
+
+    QThreadPool pool;
+    QMimeDatabase mimeDatabase;
+    quint64 nextRequest = 0;
+    std::atomic<bool> stopping{false};
+    std::atomic<int> pendingTasks{0};
+    std::atomic<int> filesSeen{0};
+    std::atomic<int> directories{0};
+    int entries = 0;
+    QElapsedTimer clock;
+};
+
+// What a quick open of a file tells about it, without decoding anything
+struct ProbedMedia
+{
+    double duration = 0;
+    QString videoCodec;
+    QString audioCodec;
+    int width = 0;
+    int height = 0;
+};
+
+// Opens queued local files in secondary mpv instances with every track
+// disabled, so only the demuxer runs, and reports duration and codecs. A few
+// workers, each with its own instance, take files from one queue at idle
+// priority behind ingestion.
+class MediaProber : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MediaProber(QObject *parent = nullptr);
+    ~MediaProber() override;
+
+    void start(QThread::Priority priority);
+    void enqueue(const QStringList &paths);
+    void stop();
+
+signals:
+    // Emitted from a worker thread; files mpv could not open are left out
+    void probed(const QString &path, const ProbedMedia &media);
+
+private:
+    void work();
+    bool takePath(QString &path);
+    bool probe(mpv_handle *mpv, const QString &path, ProbedMedia *media);
+    bool waitForEvent(mpv_handle *mpv, mpv_event_id id, int timeoutMs);
+
+    QList<QThread *> workers;
+    QMutex mutex;
+    QWaitCondition wakeup;
+    QQueue<QString> queue;
+    bool stopping = false;
+};
@@ -0,0 +1,162 @@
+#include "memorybudget.h"
+#include <QFile>
+#include <QList>
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+// Share of the budget each pool may use; the rest is left for decoders,
+// renderer and libraries. The playlist is never trimmed, its share is only
+// reported against.
+static constexpr double kShares[MemoryUsage::PoolCount] = {
+    0.40,   // DemuxerForward
+    0.15,   // DemuxerBack
+    0.05,   // Thumbnails
+    0.02,   // Metadata
+    0.03,   // Playlist
+    0.05,   // FrameGrabs
+};
+
+// Shrink above this fraction of the budget, grow back below the other
+static constexpr double kHighWater = 0.90;
+static constexpr double kLowWater = 0.70;
+// System short of memory: PSI stall share, or too little available
+static constexpr double kPressurePercent = 10.0;
+static constexpr double kMinAvailableFraction = 0.05;
+// Caches shrink lazily; give a step this long before judging it
+static constexpr qint64 kSettleMs = 6000;
+static constexpr qint64 kRecoverMs = 30000;
+
+const char *MemoryUsage::poolName(Pool pool)
+{
+    switch (pool) {
+    case DemuxerForward: return "demuxer_forward";
+    case DemuxerBack:    return "demuxer_back";
+    case Thumbnails:     return "thumbnails";
+    case Metadata:       return "metadata";
+    case Playlist:       return "playlist";
+    case FrameGrabs:     return "frame_grabs";
+    default:             return "?";
+    }
+}
+
+void MemoryUsage::sampleProcess()
+{
+#ifdef Q_OS_LINUX
+    const qint64 pageSize = sysconf(_SC_PAGESIZE);
+
+    QFile statm("/proc/self/statm");
+    if (statm.open(QIODevice::ReadOnly))
+        resident = statm.readAll().split(' ').value(1).toLongLong() * pageSize;
+
+    QFile meminfo("/proc/meminfo");
+    if (meminfo.open(QIODevice::ReadOnly)) {
+        for (const QByteArray &line : meminfo.readAll().split('\n')) {
+            const QList<QByteArray> fields = line.simplified().split(' ');
+            if (fields.size() < 2)
+                continue;
+            if (fields[0] == "MemTotal:")
+                systemTotal = fields[1].toLongLong() * 1024;
+            else if (fields[0] == "MemAvailable:")
+                systemAvailable = fields[1].toLongLong() * 1024;
+        }
+    }
+
+    // Pressure stall information, kernels 4.20 and later
+    QFile pressure("/proc/pressure/memory");
+    if (pressure.open(QIODevice::ReadOnly)) {
+        const QByteArray some = pressure.readLine();
+        const int at = some.indexOf("avg10=");
+        if (some.startsWith("some") && at >= 0)
+            systemPressure = some.mid(at + 6).split(' ').value(0).toDouble();
+    }
+#endif
+}
+
+qint64 MemoryUsage::accounted() const
+{
+    qint64 sum = 0;
+    for (qint64 bytes : pools)
+        sum += bytes;
+    return sum;
+}
+
+QJsonObject MemoryUsage::toJson() const
+{
+    QJsonObject poolsJson;
+    for (int i = 0; i < PoolCount; ++i)
+        poolsJson.insert(poolName(static_cast<Pool>(i)), pools[i]);
+
+    return QJsonObject{
+        {"pools", poolsJson},
+        {"accounted", accounted()},
+        {"resident", resident},
+        {"system_total", systemTotal},
+        {"system_available", systemAvailable},
+        {"system_pressure", systemPressure},
+    };
+}
+
+void MemoryBudget::setBudget(qint64 bytes)
+{
+    total = qMax<qint64>(0, bytes);
+    shrinkLevel = 0;
+    lastChangeMs = -1;
+    clearSinceMs = -1;
+}
+
+qint64 MemoryBudget::limit(MemoryUsage::Pool pool) const
+{
+    if (!isEnabled())
+        return -1;
+    return static_cast<qint64>(total * kShares[pool]) >> shrinkLevel;
+}
+
+bool MemoryBudget::report(const MemoryUsage &usage, qint64 nowMs)
+{
+    if (!isEnabled())
+        return false;
+
+    const bool systemShort = usage.systemPressure >= kPressurePercent
+        || (usage.systemTotal > 0 && usage.systemAvailable < usage.systemTotal * kMinAvailableFraction);
+    const bool settled = lastChangeMs < 0 || nowMs - lastChangeMs >= kSettleMs;
+
+    if (systemShort || usage.resident >= total * kHighWater) {
+        clearSinceMs = -1;
+        if (shrinkLevel >= kMaxLevel || !settled)
+            return false;
+        ++shrinkLevel;
+        lastChangeMs = nowMs;
+        return true;
+    }
+
+    if (usage.resident >= total * kLowWater) {
+        clearSinceMs = -1;
+        return false;
+    }
+
+    if (clearSinceMs < 0)
+        clearSinceMs = nowMs;
+    if (shrinkLevel == 0 || nowMs - clearSinceMs < kRecoverMs || !settled)
+        return false;
+
+    --shrinkLevel;
+    lastChangeMs = nowMs;
+    clearSinceMs = nowMs;
+    return true;
+}
+
+QJsonObject MemoryBudget::toJson() const
+{
+    QJsonObject limits;
+    for (int i = 0; i < MemoryUsage::PoolCount; ++i) {
+        const auto pool = static_cast<MemoryUsage::Pool>(i);
+        limits.insert(MemoryUsage::poolName(pool), limit(pool));
+    }
+
+    return QJsonObject{
+        {"budget", total},
+        {"level", shrinkLevel},
+        {"limits", limits},
+    };
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <QJsonObject>
+#include <QtGlobal>
+#include <array>
+
+// Memory the player can account for, by pool, plus what the process and the
+// system look like from outside
+struct MemoryUsage
+{
+    enum Pool {
+        DemuxerForward,   // demuxer cache ahead of the playhead
+        DemuxerBack,      // demuxer cache behind it
+        Thumbnails,
+        Metadata,         // probe cache, keyframe index and background probes
+        Playlist,
+        FrameGrabs,       // frame grab buffer pool
+        PoolCount
+    };
+
+    std::array<qint64, PoolCount> pools{};
+    qint64 resident = 0;          // process RSS; 0 where unknown
+    qint64 systemTotal = 0;
+    qint64 systemAvailable = 0;
+    double systemPressure = -1;   // PSI "some" avg10 in percent; -1 where unsupported
+
+    static const char *poolName(Pool pool);
+
+    // Fills in the process and system figures (Linux /proc; left at zero elsewhere)
+    void sampleProcess();
+    qint64 accounted() const;
+    QJsonObject toJson() const;
+};
+
+// One memory budget split into per-pool limits. While the process nears the
+// budget or the system runs short of memory the limits halve, one step per
+// sample once the previous step had time to take effect; they grow back one
+// step at a time after usage has stayed well below the budget for a while.
+class MemoryBudget
+{
+public:
+    // 0 leaves every pool at its own default; usage is still accounted
+    void setBudget(qint64 bytes);
+    qint64 budget() const { return total; }
+    bool isEnabled() const { return total > 0; }
+
+    // Current limit for a pool, -1 when it has none
+    qint64 limit(MemoryUsage::Pool pool) const;
+    int level() const { return shrinkLevel; }
+
+    // Periodic sample; true when the level changed and limits need applying
+    bool report(const MemoryUsage &usage, qint64 nowMs);
+
+    QJsonObject toJson() const;
+
+    static constexpr int kMaxLevel = 3;
+
+private:
+    qint64 total = 0;
+    int shrinkLevel = 0;
+    qint64 lastChangeMs = -1;
+    qint64 clearSinceMs = -1;
+};
@@ -0,0 +1,64 @@
+#include "mpvcore.h"
+#include "mpvproperty.h"
+#include <QDebug>
+#include <QElapsedTimer>
+
+static mpv_handle *createMpv(const char *owner, MpvOptionList base, MpvOptionList options)
+{
+    mpv_handle *mpv = mpv_create();
+    if (!mpv) {
+        qWarning() << owner << ": could not create mpv instance";
+        return nullptr;
+    }
+
+    for (const auto &option : base)
+        mpvSetOption(mpv, option.first, option.second);
+    for (const auto &option : options)
+        mpvSetOption(mpv, option.first, option.second);
+
+    const int status = mpv_initialize(mpv);
+    if (status < 0) {
+        qWarning() << owner << ": could not initialize mpv:" << mpv_error_string(status);
+        mpv_destroy(mpv);
+        return nullptr;
+    }
+    return mpv;
+}
+
+mpv_handle *createRenderMpv(const char *owner, MpvOptionList options)
+{
+    return createMpv(owner, {
+        // Frames go to the render API instead of a window of mpv's own
+        {"vo", "libmpv"},
+        // Safe hardware decoding; avoid forcing CUDA on systems without it
+        {"hwdec", "auto-safe"},
+        {"keepaspect", "yes"},
+    }, options);
+}
+
+mpv_handle *createSecondaryMpv(const char *owner, MpvOptionList options)
+{
+    return createMpv(owner, {
+        {"config", "no"},
+        {"load-scripts", "no"},
+        {"ytdl", "no"},
+    }, options);
+}
+
+bool waitForMpvEvent(mpv_handle *mpv, mpv_event_id id, int timeoutMs, const std::function<bool()> &interrupted)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    while (timer.elapsed() < timeoutMs) {
+        if (interrupted())
+            return false;
+
+        mpv_event *event = mpv_wait_event(mpv, 0.05);
+        if (event->event_id == id)
+            return true;
+        if (event->event_id == MPV_EVENT_SHUTDOWN || event->event_id == MPV_EVENT_END_FILE)
+            return false;
+    }
+    return false;
+}
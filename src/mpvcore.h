@@ -0,0 +1,27 @@
+#pragma once
+#include <functional>
+#include <initializer_list>
+#include <utility>
+#include <mpv/client.h>
+
+// Setting up mpv cores: the player's and the video wall's, which render
+// through libmpv, and the headless ones workers run on their own threads
+// (thumbnails, keyframe index, media probing). mpv needs LC_NUMERIC "C",
+// which is set once on the GUI thread before any core is created;
+// setlocale is not thread-safe.
+
+using MpvOptionList = std::initializer_list<std::pair<const char *, const char *>>;
+
+// A core for the libmpv render API with hardware decoding where safe and
+// the aspect ratio kept, `options` on top. Null on failure, with a warning
+// naming `owner`.
+mpv_handle *createRenderMpv(const char *owner, MpvOptionList options);
+
+// A core that ignores the user's config, scripts and youtube-dl, with
+// `options` on top. Call on the thread that will use it. Null on failure,
+// with a warning naming `owner`.
+mpv_handle *createSecondaryMpv(const char *owner, MpvOptionList options);
+
+// Drains the core's events until `id` arrives. False on timeout, shutdown,
+// a file ending first, or as soon as `interrupted` returns true.
+bool waitForMpvEvent(mpv_handle *mpv, mpv_event_id id, int timeoutMs, const std::function<bool()> &interrupted);
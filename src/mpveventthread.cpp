@@ -0,0 +1,235 @@
+#include "mpveventthread.h"
+#include "framegrabber.h"
+#include <limits>
+
+// How often updates stuck behind a full ring are offered to it again
+static constexpr double kOverflowRetrySeconds = 0.005;
+
+QVariant mpvNodeToVariant(const mpv_node *node)
+{
+    switch (node->format) {
+    case MPV_FORMAT_STRING:
+        return QString::fromUtf8(node->u.string);
+    case MPV_FORMAT_FLAG:
+        return node->u.flag != 0;
+    case MPV_FORMAT_INT64:
+        return static_cast<qint64>(node->u.int64);
+    case MPV_FORMAT_DOUBLE:
+        return node->u.double_;
+    case MPV_FORMAT_NODE_ARRAY: {
+        QVariantList list;
+        list.reserve(node->u.list->num);
+        for (int i = 0; i < node->u.list->num; ++i)
+            list.append(mpvNodeToVariant(&node->u.list->values[i]));
+        return list;
+    }
+    case MPV_FORMAT_NODE_MAP: {
+        QVariantMap map;
+        for (int i = 0; i < node->u.list->num; ++i)
+            map.insert(QString::fromUtf8(node->u.list->keys[i]), mpvNodeToVariant(&node->u.list->values[i]));
+        return map;
+    }
+    default:
+        return QVariant();
+    }
+}
+
+MpvEventThread::MpvEventThread(mpv_handle *mpv, QObject *parent)
+: QThread(parent)
+, mpv(mpv)
+{
+    setObjectName("mpv-events");
+}
+
+MpvEventThread::~MpvEventThread()
+{
+    stop();
+}
+
+void MpvEventThread::stop()
+{
+    if (!isRunning())
+        return;
+
+    stopping.store(true);
+    mpv_wakeup(mpv);
+    wait();
+}
+
+void MpvEventThread::run()
+{
+    while (!stopping.load(std::memory_order_acquire)) {
+        // Overflowed updates are retried while mpv is quiet
+        mpv_event *event = mpv_wait_event(mpv, overflow.empty() ? -1 : kOverflowRetrySeconds);
+        flushOverflow();
+        if (event->event_id == MPV_EVENT_NONE)
+            continue;
+        events.fetch_add(1, std::memory_order_relaxed);
+
+        MpvUpdate update;
+        if (!translate(event, update))
+            continue;
+
+        const bool shutdown = update.kind == MpvUpdate::Shutdown;
+        enqueue(std::move(update));
+        if (shutdown) {
+            // mpv has nothing more to send; waiting is harmless now
+            while (!overflow.empty() && !stopping.load(std::memory_order_acquire)) {
+                QThread::msleep(5);
+                flushOverflow();
+            }
+            break;
+        }
+    }
+}
+
+bool MpvEventThread::translate(const mpv_event *event, MpvUpdate &update) const
+{
+    update.id = event->reply_userdata;
+    update.error = event->error;
+
+    switch (event->event_id) {
+    case MPV_EVENT_PROPERTY_CHANGE:
+    case MPV_EVENT_GET_PROPERTY_REPLY: {
+        const auto *prop = static_cast<const mpv_event_property *>(event->data);
+        update.kind = event->event_id == MPV_EVENT_PROPERTY_CHANGE ? MpvUpdate::Property
+                                                                   : MpvUpdate::PropertyReply;
+        update.available = prop->data != nullptr;
+        if (!update.available)
+            return true;
+
+        switch (prop->format) {
+        case MPV_FORMAT_DOUBLE:
+            update.number = *static_cast<double *>(prop->data);
+            break;
+        case MPV_FORMAT_INT64:
+            update.number = static_cast<double>(*static_cast<int64_t *>(prop->data));
+            break;
+        case MPV_FORMAT_FLAG:
+            update.number = *static_cast<int *>(prop->data);
+            break;
+        case MPV_FORMAT_STRING:
+            update.text = QString::fromUtf8(*static_cast<char **>(prop->data));
+            break;
+        case MPV_FORMAT_NODE:
+            update.node = mpvNodeToVariant(static_cast<const mpv_node *>(prop->data));
+            break;
+        default:
+            update.available = false;
+            break;
+        }
+        return true;
+    }
+    case MPV_EVENT_START_FILE:
+        update.kind = MpvUpdate::StartFile;
+        return true;
+    case MPV_EVENT_FILE_LOADED:
+        update.kind = MpvUpdate::FileLoaded;
+        return true;
+    case MPV_EVENT_END_FILE: {
+        const auto *end = static_cast<const mpv_event_end_file *>(event->data);
+        if (!end)
+            return false;
+        update.kind = MpvUpdate::EndFile;
+        update.endReason = end->reason;
+        update.error = end->error;
+        return true;
+    }
+    case MPV_EVENT_PLAYBACK_RESTART:
+        update.kind = MpvUpdate::PlaybackRestart;
+        return true;
+    case MPV_EVENT_COMMAND_REPLY:
+        update.kind = MpvUpdate::CommandReply;
+        // The pixels are copied out now so mpv can free its reply
+        if (update.id == AsyncScreenshot) {
+            const auto *reply = static_cast<const mpv_event_command *>(event->data);
+            update.number = event->error >= 0 && framePool ? framePool->store(&reply->result) : -1;
+        }
+        return true;
+    case MPV_EVENT_SET_PROPERTY_REPLY:
+        // Successful sets need no attention
+        if (event->error >= 0)
+            return false;
+        update.kind = MpvUpdate::SetPropertyReply;
+        return true;
+    case MPV_EVENT_HOOK:
+        update.kind = MpvUpdate::Hook;
+        update.hookId = static_cast<const mpv_event_hook *>(event->data)->id;
+        return true;
+    case MPV_EVENT_SHUTDOWN:
+        update.kind = MpvUpdate::Shutdown;
+        return true;
+    default:
+        return false;
+    }
+}
+
+void MpvEventThread::enqueue(MpvUpdate &&update)
+{
+    update.order = ++arrivals;
+
+    if (update.kind == MpvUpdate::Property && update.id >= 1 && update.id <= ObserveLast) {
+        std::lock_guard<std::mutex> lock(latestMutex);
+        LatestProperty &slot = latest[update.id];
+        slot.update = std::move(update);
+        slot.pending = true;
+    } else if (!overflow.empty() || !queue.push(std::move(update))) {
+        // A busy GUI must not keep mpv waiting: its own queue is bounded
+        // and drops events once full
+        std::lock_guard<std::mutex> lock(latestMutex);
+        if (overflow.empty())
+            overflowOrder = update.order;
+        overflow.push_back(std::move(update));
+    }
+    notify();
+}
+
+void MpvEventThread::flushOverflow()
+{
+    if (overflow.empty())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(latestMutex);
+        while (!overflow.empty() && queue.push(std::move(overflow.front())))
+            overflow.pop_front();
+        overflowOrder = overflow.empty() ? 0 : overflow.front().order;
+    }
+    notify();
+}
+
+bool MpvEventThread::next(MpvUpdate &update)
+{
+    std::lock_guard<std::mutex> lock(latestMutex);
+
+    // Under the lock every ring update older than a pending property is
+    // already visible
+    if (!holding)
+        holding = queue.pop(held);
+
+    // Properties newer than an update still in the overflow wait for it
+    const quint64 limit = overflowOrder ? overflowOrder : std::numeric_limits<quint64>::max();
+    LatestProperty *oldest = nullptr;
+    for (LatestProperty &slot : latest) {
+        if (slot.pending && slot.update.order < limit && (!oldest || slot.update.order < oldest->update.order))
+            oldest = &slot;
+    }
+
+    if (oldest && (!holding || oldest->update.order < held.order)) {
+        update = std::move(oldest->update);
+        oldest->pending = false;
+        return true;
+    }
+    if (holding) {
+        update = std::move(held);
+        holding = false;
+        return true;
+    }
+    return false;
+}
+
+void MpvEventThread::notify()
+{
+    if (!wakePending.exchange(true, std::memory_order_acq_rel))
+        emit updatesAvailable();
+}
@@ -0,0 +1,143 @@
+#pragma once
+#include <QThread>
+#include <QString>
+#include <QVariant>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <mpv/client.h>
+#include "spscqueue.h"
+
+class FramePool;
+
+// Reply ids passed to mpv_observe_property; events are told apart by these
+// instead of by property name. Dense and in the order of
+// MpvWidget::observedProperties, which is indexed by them.
+enum MpvObserveId : quint64 {
+    ObserveTimePos = 1,
+    ObserveDuration = 2,
+    ObservePause = 3,
+    ObservePausedForCache = 4,
+    ObserveCacheDuration = 5,
+    ObserveTrackList = 6,
+    ObserveContainerFps = 7,
+    ObserveCacheState = 8,
+    ObserveChapterList = 9,
+    ObserveDecoderDrops = 10,
+    ObserveLast = ObserveDecoderDrops,
+};
+
+// Reply ids for mpv_hook_add
+enum MpvHookId : quint64 {
+    HookPreloaded = 1,
+};
+
+// Reply ids for asynchronous commands and property reads (separate namespace from observe ids)
+enum MpvAsyncId : quint64 {
+    AsyncSeek = 1,
+    AsyncPrefetch = 2,
+    AsyncPlaylistRemove = 3,
+    AsyncTimePos = 4,
+    AsyncSetProperty = 5,
+    AsyncFrameStep = 6,
+    AsyncScreenshot = 7,
+    AsyncVideoReload = 8,
+};
+
+QVariant mpvNodeToVariant(const mpv_node *node);
+
+// Compact, already-decoded mpv event handed from the event thread to the GUI
+struct MpvUpdate
+{
+    enum Kind : quint8 {
+        Property,
+        StartFile,
+        FileLoaded,
+        EndFile,
+        PlaybackRestart,
+        CommandReply,
+        PropertyReply,   // mpv_get_property_async; decoded like Property
+        SetPropertyReply,
+        Hook,            // mpv waits until mpv_hook_continue(hookId)
+        Shutdown,
+    };
+
+    Kind kind = Property;
+    bool available = false;   // property has a value (not MPV_FORMAT_NONE)
+    int error = 0;            // mpv error code for replies and end-file
+    int endReason = 0;        // mpv_end_file_reason
+    quint64 id = 0;           // reply_userdata
+    quint64 hookId = 0;       // for Hook
+    double number = 0;        // DOUBLE / INT64 / FLAG properties; pool slot for AsyncScreenshot
+    QString text;             // STRING properties
+    QVariant node;            // NODE properties
+    quint64 order = 0;        // arrival order, to merge coalesced properties back in
+};
+
+// Drains mpv_wait_event on its own thread and hands decoded updates to the
+// GUI thread without ever waiting for it. Observed properties are coalesced:
+// only the latest value per observe id is kept. Everything else (file
+// lifecycle, seeks, replies, hooks) goes through a ring of its own and, should
+// that fill up, an overflow list. At most one updatesAvailable() notification
+// is pending at a time, no matter how many events mpv produces.
+class MpvEventThread : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit MpvEventThread(mpv_handle *mpv, QObject *parent = nullptr);
+    ~MpvEventThread() override;
+
+    void stop();
+
+    // Grabbed frames are copied in here, off the GUI thread; set before start()
+    void setFramePool(FramePool *pool) { framePool = pool; }
+
+    // GUI side: call acknowledge() once, then next() until it returns false.
+    // Updates come out in the order mpv sent them, coalesced properties at
+    // the place of their latest value.
+    void acknowledge() { wakePending.store(false, std::memory_order_release); }
+    bool next(MpvUpdate &update);
+
+    // Events received from mpv so far (idle accounting)
+    quint64 eventCount() const { return events.load(std::memory_order_relaxed); }
+
+signals:
+    void updatesAvailable();
+
+protected:
+    void run() override;
+
+private:
+    struct LatestProperty
+    {
+        MpvUpdate update;
+        bool pending = false;
+    };
+
+    bool translate(const mpv_event *event, MpvUpdate &update) const;
+    void enqueue(MpvUpdate &&update);
+    void flushOverflow();
+    void notify();
+
+    mpv_handle *mpv;
+    FramePool *framePool = nullptr;
+    SpscQueue<MpvUpdate, 1024> queue;
+
+    // Event thread only
+    std::deque<MpvUpdate> overflow;
+    quint64 arrivals = 0;
+
+    // Guarded by latestMutex
+    std::mutex latestMutex;
+    LatestProperty latest[ObserveLast + 1];
+    quint64 overflowOrder = 0;   // order of the oldest overflowed update, 0 if none
+
+    // GUI thread only
+    MpvUpdate held;
+    bool holding = false;
+
+    std::atomic<bool> wakePending{false};
+    std::atomic<bool> stopping{false};
+    std::atomic<quint64> events{0};
+};
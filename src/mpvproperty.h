@@ -0,0 +1,82 @@
+#pragma once
+#include <QByteArray>
+#include <QDebug>
+#include <QString>
+#include <QtGlobal>
+#include <mpv/client.h>
+#include "mpveventthread.h"
+
+// Typed access to mpv properties, passing values in their native format
+// instead of formatting them to strings and having mpv parse them back.
+
+template <typename T> struct MpvFormat;
+
+template <> struct MpvFormat<double>
+{
+    static constexpr mpv_format format = MPV_FORMAT_DOUBLE;
+    using Storage = double;
+};
+
+template <> struct MpvFormat<qint64>
+{
+    static constexpr mpv_format format = MPV_FORMAT_INT64;
+    using Storage = int64_t;
+};
+
+template <> struct MpvFormat<bool>
+{
+    static constexpr mpv_format format = MPV_FORMAT_FLAG;
+    using Storage = int;
+};
+
+template <> struct MpvFormat<const char *>
+{
+    static constexpr mpv_format format = MPV_FORMAT_STRING;
+    using Storage = const char *;
+};
+
+// Options in their string form, as on mpv's command line; a rejected one is
+// logged and otherwise ignored
+inline int mpvSetOption(mpv_handle *mpv, const char *name, const char *value)
+{
+    const int r = mpv_set_option_string(mpv, name, value);
+    if (r < 0)
+        qWarning() << "Failed to set mpv option" << name << ":" << mpv_error_string(r);
+    return r;
+}
+
+inline int mpvSetOption(mpv_handle *mpv, const char *name, const QByteArray &value)
+{
+    return mpvSetOption(mpv, name, value.constData());
+}
+
+// Queues the change and returns at once; a failure arrives later as a
+// SetPropertyReply with reply id AsyncSetProperty
+template <typename T>
+int mpvSetAsync(mpv_handle *mpv, const char *name, T value)
+{
+    // mpv copies the value before returning
+    typename MpvFormat<T>::Storage data = value;
+    return mpv_set_property_async(mpv, AsyncSetProperty, name, MpvFormat<T>::format, &data);
+}
+
+// Synchronous read; `fallback` when the property is unavailable
+template <typename T>
+T mpvGet(mpv_handle *mpv, const char *name, T fallback = T())
+{
+    typename MpvFormat<T>::Storage data{};
+    if (mpv_get_property(mpv, name, MpvFormat<T>::format, &data) < 0)
+        return fallback;
+    return static_cast<T>(data);
+}
+
+template <>
+inline QString mpvGet<QString>(mpv_handle *mpv, const char *name, QString fallback)
+{
+    char *value = nullptr;
+    if (mpv_get_property(mpv, name, MPV_FORMAT_STRING, &value) < 0 || !value)
+        return fallback;
+    QString result = QString::fromUtf8(value);
+    mpv_free(value);
+    return result;
+}
@@ -1,8 +1,10 @@
 #include "mpvwidget.h"
 #include <QDebug>
 #include <clocale>
-#include <QOpenGLFunctions>
-#include <QOpenGLContext>
+#include <iterator>
+#include <utility>
+#include <QVBoxLayout>
+#include <QAbstractEventDispatcher>
 #include <QEvent>
 #include <QTimer>
 #include <QTime>
@@ -10,34 +12,104 @@
 #include <QEnterEvent>
 #include <QKeyEvent>
 #include <QScreen>
+#include <QWindow>
 #include <QMimeData>
 #include <QIcon>
 #include <QDragMoveEvent>
+#include <QPainter>
+#include <QDir>
+#include <QFileInfo>
+#include <QUrl>
+#include "fileidentity.h"
+#include "mpvcore.h"
+#include "mpvproperty.h"
+#include "startuptrace.h"
+
+
+// Create and initialize the mpv core. Runs on a worker thread while the
+// window is still being built; only the render context needs GL.
+static mpv_handle *createMpvCore()
+{
+    mpv_handle *mpv = createRenderMpv("Player", {
+        // Standard player behavior: scale to window with letterboxing/pillarboxing
+        {"keepaspect-window", "yes"},
+        {"video-unscaled", "no"},
+        {"panscan", "0"},
+        // Time video against the display's vsync; frames are resampled to the
+        // refresh rate (fed from QScreen) instead of judder-prone skipping
+        {"video-sync", "display-resample"},
+        // Open the next playlist entry while the current one is still playing
+        {"prefetch-playlist", "yes"},
+        {"gapless-audio", "weak"},
+        // Initial volume once on startup
+        {"volume", "50"},
+    });
+    if (mpv)
+        StartupTrace::mark(StartupTrace::MpvReady);
+    return mpv;
+}
 
-
-// MPV redraw callback
-static void on_mpv_redraw(void *ctx)
+// Observed properties, in reply id order: dispatch indexes this by reply_userdata
+constexpr MpvWidget::ObservedProperty MpvWidget::observedProperties[ObserveLast] = {
+    {ObserveTimePos,        "time-pos",                 MPV_FORMAT_DOUBLE, &MpvWidget::onTimePos},
+    {ObserveDuration,       "duration",                 MPV_FORMAT_DOUBLE, &MpvWidget::onDuration},
+    {ObservePause,          "pause",                    MPV_FORMAT_FLAG,   &MpvWidget::onPause},
+    {ObservePausedForCache, "paused-for-cache",         MPV_FORMAT_FLAG,   &MpvWidget::onPausedForCache},
+    {ObserveCacheDuration,  "demuxer-cache-duration",   MPV_FORMAT_DOUBLE, &MpvWidget::onCacheDuration},
+    {ObserveTrackList,      "track-list",               MPV_FORMAT_NODE,   &MpvWidget::onTrackList},
+    {ObserveContainerFps,   "container-fps",            MPV_FORMAT_DOUBLE, &MpvWidget::onContainerFps},
+    {ObserveCacheState,     "demuxer-cache-state",      MPV_FORMAT_NODE,   &MpvWidget::onCacheState},
+    {ObserveChapterList,    "chapter-list",             MPV_FORMAT_NODE,   &MpvWidget::onChapterList},
+    {ObserveDecoderDrops,   "decoder-frame-drop-count", MPV_FORMAT_INT64,  &MpvWidget::onDecoderDrops},
+};
+
+// A missing row leaves a zeroed one behind, which fails this as well
+constexpr bool MpvWidget::observedIdsInOrder()
 {
-    MpvWidget *self = static_cast<MpvWidget*>(ctx);
-    self->update();
+    for (quint64 i = 0; i < std::size(observedProperties); ++i) {
+        if (observedProperties[i].id != i + 1)
+            return false;
+    }
+    return true;
 }
 
-// MPV wakeup callback: handle events (position, duration)
-void on_mpv_events(void *ctx)
+// Upper bound for control bar refreshes; the display rate lowers it further
+static constexpr qreal kMaxControlsRefreshHz = 30.0;
+static constexpr int kCursorHideMs = 2000;
+// Memory budget checks; only run while a budget is set
+static constexpr int kMemoryCheckMs = 2000;
+// Probe cache entries kept even under the tightest budget
+static constexpr int kMinProbeEntries = 20;
+// Keyframes kept before the index is thinned, an hour at a 2 s GOP
+static constexpr int kMinKeyframes = 2048;
+// Rough size of one background probe result, codec names and hash node included
+static constexpr qint64 kProbedMediaBytes = 160;
+// Background probe results kept even under the tightest budget
+static constexpr int kMinProbedMedia = 1000;
+// Shift+S
+static constexpr int kBurstFrames = 10;
+// Larger time-pos steps are seeks, not playback
+static constexpr double kMaxPlayAdvanceSeconds = 1.0;
+static constexpr int kBurstIntervalMs = 100;
+
+static QString formatMs(qint64 us)
 {
-    MpvWidget *self = static_cast<MpvWidget*>(ctx);
-    // mpv can invoke this from non-Qt threads; defer processing to Qt main thread
-    QMetaObject::invokeMethod(self, "processMpvEvents", Qt::QueuedConnection);
+    return QString::number(us / 1000.0, 'f', 2);
 }
 
-MpvWidget::MpvWidget(QWidget *parent) : QOpenGLWidget(parent)
+MpvWidget::MpvWidget(QWidget *parent, VideoBackend::Mode renderMode) : QWidget(parent)
 {
     setlocale(LC_NUMERIC, "C");
     setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
     setMinimumSize(100, 100);
     setMouseTracking(true);
     setAcceptDrops(true);
+    setFocusPolicy(Qt::StrongFocus);
 
+    // The video surface fills the widget; everything else floats above it
+    auto *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    setupVideo(renderMode);
 
     // Create floating controls
     controls = new ControlBar(this);
@@ -50,27 +122,172 @@ MpvWidget::MpvWidget(QWidget *parent) : QOpenGLWidget(parent)
         repositionControls();
     });
 
-    // Connect MPV signals to controls
-    QTimer::singleShot(100, this, &MpvWidget::setupControlConnections);
+    // Bring up the mpv core in parallel with window and GL setup; control
+    // connections are made once it is adopted
+    coreFuture = std::async(std::launch::async, [this]() {
+        mpv_handle *handle = createMpvCore();
+        QMetaObject::invokeMethod(this, &MpvWidget::adoptCore, Qt::QueuedConnection);
+        return handle;
+    });
 
     // Track window movement to keep controls positioned
     installEventFilter(this);
 
     // Cursor hide timer
+    // Armed once per burst of mouse movement and re-armed for the remainder
     cursorHideTimer = new QTimer(this);
-    cursorHideTimer->setInterval(2000);
     cursorHideTimer->setSingleShot(true);
     connect(cursorHideTimer, &QTimer::timeout, this, [this]() {
+        const qint64 remaining = kCursorHideMs - lastMouseActivity.elapsed();
+        if (remaining > 0) {
+            cursorHideTimer->start(static_cast<int>(remaining));
+            return;
+        }
         if (!isControlsHovered()) {
             setCursor(Qt::BlankCursor);
         }
     });
+
+    // Idle accounting: every wakeup of the GUI event loop while not Active
+    connect(QAbstractEventDispatcher::instance(), &QAbstractEventDispatcher::awake, this, [this]() {
+        if (power != PowerState::Active)
+            ++idleGuiWakeups;
+    });
+
+    seekScheduler = new SeekScheduler(this);
+
+    // Playlist changes are written out in one go shortly after they stop
+    playlistSaveTimer = new QTimer(this);
+    playlistSaveTimer->setSingleShot(true);
+    playlistSaveTimer->setInterval(2000);
+    connect(playlistSaveTimer, &QTimer::timeout, this, [this]() {
+        if (!playlistFile.isEmpty())
+            playlist.save(playlistFile);
+    });
+
+    thumbnailer = new Thumbnailer(this);
+    connect(thumbnailer, &Thumbnailer::thumbnailReady, this, &MpvWidget::updateSeekPreview);
+    connect(thumbnailer, &Thumbnailer::keyframeFound, this, [this](double seconds) {
+        if (!probeKey.isEmpty())
+            probeInfo.addKeyframe(seconds);
+        keyframes.add({seconds});
+    });
+
+    keyframeIndexer = new KeyframeIndexer(this);
+    connect(keyframeIndexer, &KeyframeIndexer::keyframesFound, this,
+            [this](quint64 generation, const QList<double> &times, bool finished) {
+        if (generation != keyframeGeneration)
+            return;
+        keyframes.add(times);
+        keyframes.setComplete(finished);
+        if (!probeKey.isEmpty()) {
+            for (double seconds : times)
+                probeInfo.addKeyframe(seconds);
+        }
+    }, Qt::QueuedConnection);
+    keyframeIndexer->start(QThread::IdlePriority);
+    shuttle = new Shuttle(seekScheduler, &state, &keyframes, this);
+    grabber = new FrameGrabber(this);
+
+    ingest = new MediaIngest(this);
+    prober = new MediaProber(this);
+    connect(ingest, &MediaIngest::entriesFound, this, [this](quint64 request, const QStringList &urls) {
+        enqueue(urls);
+        if (request == playFirstRequest) {
+            playFirstRequest = 0;
+            play(urls.first());
+        }
+
+        QStringList local;
+        for (const QString &url : urls) {
+            if (!url.contains("://") && !probedMedia.contains(url))
+                local << url;
+        }
+        prober->enqueue(local);
+    });
+    connect(ingest, &MediaIngest::finished, this, [](int entries, int filesSeen, int directories, qint64 elapsedMs) {
+        qInfo().noquote() << QString("Opened %1 entries (%2 files in %3 directories looked at) in %4 ms")
+                                 .arg(entries).arg(filesSeen).arg(directories).arg(elapsedMs);
+    });
+    connect(prober, &MediaProber::probed, this, [this](const QString &path, const ProbedMedia &media) {
+        if (!probedMedia.contains(path))
+            probedOrder.enqueue(path);
+        probedMedia.insert(path, media);
+        trimProbedMedia();
+    }, Qt::QueuedConnection);
+    prober->start(QThread::IdlePriority);
+
+    memoryTimer = new QTimer(this);
+    memoryTimer->setInterval(kMemoryCheckMs);
+    connect(memoryTimer, &QTimer::timeout, this, &MpvWidget::checkMemory);
+
+    // Track and chapter lists arrive shortly after the file is loaded
+    probeCache = new ProbeCache(this);
+    probeStoreTimer = new QTimer(this);
+    probeStoreTimer->setSingleShot(true);
+    probeStoreTimer->setInterval(1000);
+    connect(probeStoreTimer, &QTimer::timeout, this, [this]() { storeProbe(state.timePos); });
+
+    seekPreview = new QLabel(this);
+    seekPreview->setAttribute(Qt::WA_TransparentForMouseEvents);
+    seekPreview->setAlignment(Qt::AlignCenter);
+    seekPreview->setStyleSheet(
+        "background-color: rgba(20,20,20,220);"
+        "color: white;"
+        "border: 1px solid rgba(255,255,255,40);"
+        "border-radius: 4px;"
+        "padding: 2px;"
+    );
+    seekPreview->hide();
+
+    // Coalesces state changes into at most one controls refresh per interval
+    controlsRefreshTimer = new QTimer(this);
+    controlsRefreshTimer->setSingleShot(true);
+    connect(controlsRefreshTimer, &QTimer::timeout, this, [this]() {
+        if (positionMoved) {
+            positionMoved = false;
+            emit stateChanged();
+        }
+        refreshControls();
+    });
+
+    // Stats overlay (toggled with I); refreshed a few times per second while shown
+    statsOverlay = new StatsOverlay(this);
+    statsOverlay->move(12, 12);
+
+    statsTimer = new QTimer(this);
+    statsTimer->setInterval(250);
+    connect(statsTimer, &QTimer::timeout, this, &MpvWidget::updateStatsOverlay);
+
+    // Plain child widgets are painted into the backing store, which sits below
+    // a native video window; they need windows of their own to stay visible
+    if (video->mode() == VideoBackend::Direct) {
+        controls->setAttribute(Qt::WA_NativeWindow);
+        seekPreview->setAttribute(Qt::WA_NativeWindow);
+        statsOverlay->setAttribute(Qt::WA_NativeWindow);
+    }
+
+    frameClock.start();
 }
 
 MpvWidget::~MpvWidget()
 {
-    if (mpv_gl)
-        mpv_render_context_free(mpv_gl);
+    if (playlistSaveTimer->isActive())
+        playlist.save(playlistFile);
+    storeProbe(state.timePos);
+    shuttle->setSource(QString());
+    keyframeIndexer->stop();
+    prober->stop();
+
+    // Stop draining events before the handle goes away
+    if (eventThread)
+        eventThread->stop();
+
+    video->detach();
+
+    // A core that was never adopted still has to be torn down
+    if (coreFuture.valid())
+        mpv = coreFuture.get();
 
     if (mpv)
         mpv_destroy(mpv);
@@ -110,32 +327,155 @@ bool MpvWidget::isControlsHovered() const
     return controls->geometry().contains(cursorPos);
 }
 
-void MpvWidget::setupControlConnections()
+void MpvWidget::setMpvOption(const QString &name, const QString &value)
 {
-    if (!controls || !mpv) return;
+    const QByteArray n = name.toUtf8();
+    const QByteArray v = value.toUtf8();
+    // Decode tuning writes these per file and falls back to the user's value
+    decodeTuner.setUserOption(n, v);
 
-    // Previous button
-    connect(controls->prevButton, &QPushButton::clicked, this, &MpvWidget::playPrev);
+    if (!mpv) {
+        extraOptions.append(qMakePair(n, v));
+        return;
+    }
 
-    // Play/Pause button
-    connect(controls->playButton, &QPushButton::clicked, this, [this]() {
-        if (!mpv) return;
+    mpvSetOption(mpv, n.constData(), v);
+}
 
-        if (isPaused) {
-            mpv_set_property_string(mpv, "pause", "no");
+void MpvWidget::setFrameStatsEnabled(bool enabled)
+{
+    if (enabled)
+        frameStats.reset();
+    frameStatsEnabled = enabled;
+    video->setFrameStats(enabled ? &frameStats : nullptr);
+}
 
-            // ⬇⬇ SET PAUSE ICON
-            controls->playButton->setIcon(QIcon(":/icons/pause.svg"));
+void MpvWidget::toggleStatsOverlay()
+{
+    const bool visible = !statsOverlay->isVisible();
+    setFrameStatsEnabled(visible);
+
+    if (visible) {
+        updateStatsOverlay();
+        statsOverlay->show();
+        statsOverlay->raise();
+        statsTimer->start();
+    } else {
+        statsTimer->stop();
+        statsOverlay->hide();
+    }
+}
 
-            isPaused = false;
-        } else {
-            mpv_set_property_string(mpv, "pause", "yes");
+void MpvWidget::updateStatsOverlay()
+{
+    if (!mpv) {
+        statsOverlay->setLines({QStringLiteral("mpv not initialized")});
+        return;
+    }
 
-            // ⬇⬇ SET PLAY ICON
-            controls->playButton->setIcon(QIcon(":/icons/play.svg"));
+    const FrameTimeRing &render = frameStats.renderTime;
+    const FrameTimeRing &interval = frameStats.frameInterval;
+
+    const double vfFps = mpvGet<double>(mpv, "estimated-vf-fps");
+    const double screenHz = screen() ? screen()->refreshRate() : 0;
+    const qint64 targetUs = vfFps > 0 ? static_cast<qint64>(1e6 / vfFps) : 0;
+
+    QString decoder = mpvGet<QString>(mpv, "video-codec");
+    const QString hwdec = mpvGet<QString>(mpv, "hwdec-current");
+    if (!hwdec.isEmpty() && hwdec != "no")
+        decoder += QString(" [%1]").arg(hwdec);
+
+    const StreamStats stream = streamStats();
+
+    QStringList lines;
+    lines << QString("Render    p50 %1  p95 %2  p99 %3 ms  (last %4)")
+                 .arg(formatMs(render.percentile(0.50)), formatMs(render.percentile(0.95)),
+                      formatMs(render.percentile(0.99)), formatMs(render.last()))
+          << QString("Interval  p50 %1  p95 %2  p99 %3 ms")
+                 .arg(formatMs(interval.percentile(0.50)), formatMs(interval.percentile(0.95)),
+                      formatMs(interval.percentile(0.99)))
+          << QString("Frames    %1 painted  %2 fps video  %3 Hz display")
+                 .arg(frameStats.framesRendered)
+                 .arg(vfFps, 0, 'f', 3)
+                 .arg(screenHz, 0, 'f', 2)
+          << QString("Dropped   vo %1  decoder %2  delayed %3")
+                 .arg(mpvGet<qint64>(mpv, "frame-drop-count"))
+                 .arg(mpvGet<qint64>(mpv, "decoder-frame-drop-count"))
+                 .arg(mpvGet<qint64>(mpv, "vo-delayed-frame-count"))
+          << QString("Seek      last %1  p95 %2 ms  (%3 samples)")
+                 .arg(formatMs(seekScheduler->latency().last()), formatMs(seekScheduler->latency().percentile(0.95)))
+                 .arg(seekScheduler->latency().count())
+          << QString("Shuttle   %1x  step last %2  p95 %3 ms  (%4 steps)  %5 keyframes%6")
+                 .arg(shuttle->rate())
+                 .arg(formatMs(shuttle->stepLatency().last()), formatMs(shuttle->stepLatency().percentile(0.95)))
+                 .arg(shuttle->stepLatency().count())
+                 .arg(keyframes.size())
+                 .arg(keyframes.isComplete() ? QString() : QStringLiteral(" (indexing)"))
+          << QString("Capture   last %1  p95 %2 ms  queued %3 (peak %4)  saved %5  dropped %6")
+                 .arg(formatMs(grabber->latency().last()), formatMs(grabber->latency().percentile(0.95)))
+                 .arg(grabber->stats().queued)
+                 .arg(grabber->stats().peakQueued)
+                 .arg(grabber->stats().saved)
+                 .arg(grabber->stats().dropped)
+          << QString("Gapless   last %1  p95 %2 ms  (%3 transitions)")
+                 .arg(formatMs(transitionLatency.last()), formatMs(transitionLatency.percentile(0.95)))
+                 .arg(transitionLatency.count())
+          // The rate handed to mpv, which can lag a screen change by a moment
+          << QString("Pacing    %1 Hz  (mpv estimate %2 Hz)  jitter %3  mistimed %4")
+                 .arg(displayFps, 0, 'f', 3)
+                 .arg(mpvGet<double>(mpv, "estimated-display-fps"), 0, 'f', 3)
+                 .arg(mpvGet<double>(mpv, "vsync-jitter"), 0, 'f', 4)
+                 .arg(mpvGet<qint64>(mpv, "mistimed-frame-count"))
+          << QString("A/V sync  %1 s").arg(mpvGet<double>(mpv, "avsync"), 0, 'f', 4)
+          << QString("Decoder   %1").arg(decoder.isEmpty() ? QStringLiteral("-") : decoder)
+          << QString("Tuning    %1").arg(decodeTuning ? decodeConfig.describe() : QStringLiteral("off"))
+          << QString("Cache     %1 s ahead  %2 MiB  %3 ranges  in %4 kbit/s  [%5]%6")
+                 .arg(state.cacheDuration, 0, 'f', 1)
+                 .arg(state.cacheForwardBytes / (1024.0 * 1024.0), 0, 'f', 1)
+                 .arg(state.cachedRanges.size())
+                 .arg(state.cacheInputRate * 8 / 1000, 0, 'f', 0)
+                 .arg(stream.profile)
+                 .arg(state.pausedForCache ? QStringLiteral("  STALLED") : QString())
+          << QString("Stalls    %1  rebuffering %2 s")
+                 .arg(stream.stalls)
+                 .arg(stream.rebufferMs / 1000.0, 0, 'f', 1)
+          << QString("Output    %1").arg(audioOnly ? QStringLiteral("none (audio only)") : VideoBackend::modeName(video->mode()));
+
+    const MemoryUsage memory = memoryUsage();
+    auto mib = [](qint64 bytes) { return QString::number(bytes / (1024.0 * 1024.0), 'f', 1); };
+    lines << QString("Memory    rss %1 MiB  budget %2  level %3  pressure %4")
+                 .arg(mib(memory.resident))
+                 .arg(budget.isEnabled() ? mib(budget.budget()) + " MiB" : QStringLiteral("off"))
+                 .arg(budget.level())
+                 .arg(memory.systemPressure >= 0 ? QString::number(memory.systemPressure, 'f', 1) + '%' : QStringLiteral("-"))
+          << QString("Pools     demux %1+%2  thumbs %3  meta %4  playlist %5  grabs %6 MiB")
+                 .arg(mib(memory.pools[MemoryUsage::DemuxerForward]), mib(memory.pools[MemoryUsage::DemuxerBack]),
+                      mib(memory.pools[MemoryUsage::Thumbnails]), mib(memory.pools[MemoryUsage::Metadata]),
+                      mib(memory.pools[MemoryUsage::Playlist]), mib(memory.pools[MemoryUsage::FrameGrabs]));
+
+    // The overlay's own refresh timer accounts for 4 of the wakeups per second
+    const IdleStats idle = idleStats();
+    if (power == PowerState::Paused) {
+        lines << QString("Idle      %1 s  wakeups gui %2  mpv %3")
+                     .arg(idle.idleMs / 1000.0, 0, 'f', 1)
+                     .arg(idle.guiWakeups)
+                     .arg(idle.mpvEvents);
+    }
 
-            isPaused = true;
-        }
+    statsOverlay->setLines(lines);
+    statsOverlay->setFrameHistory(interval.history(), targetUs);
+}
+
+void MpvWidget::setupControlConnections()
+{
+    if (!controls || !mpv) return;
+
+    // Previous button
+    connect(controls->prevButton, &QPushButton::clicked, this, &MpvWidget::playPrev);
+
+    // Play/Pause button; the icon follows the observed pause property
+    connect(controls->playButton, &QPushButton::clicked, this, [this]() {
+        setPaused(!state.paused);
     });
 
 
@@ -145,246 +485,372 @@ void MpvWidget::setupControlConnections()
 
 
 
+    // Seek slider hover preview
+    connect(controls, &ControlBar::seekHovered, this, &MpvWidget::showSeekPreview);
+    connect(controls, &ControlBar::seekHoverEnded, this, [this]() {
+        seekPreview->hide();
+        previewSeconds = -1;
+    });
+
     // Seek slider
     connect(controls->seekSlider, &QSlider::sliderPressed, this, [this]() {
         isSeekingManually = true;
     });
 
+    // Keyframe seeks while dragging, one exact seek where the handle is let go
     connect(controls->seekSlider, &QSlider::sliderReleased, this, [this]() {
         isSeekingManually = false;
+        if (state.duration > 0) {
+            const QSlider *slider = controls->seekSlider;
+            seekScheduler->seek(state.duration * slider->value() / slider->maximum(), true);
+        }
     });
 
     connect(controls->seekSlider, &QSlider::sliderMoved, this, [this](int value) {
-        if (!mpv) return;
-
-        double duration = 0;
-        mpv_get_property(mpv, "duration", MPV_FORMAT_DOUBLE, &duration);
-
-        if (duration > 0) {
-            double seekTo = duration * value / controls->seekSlider->maximum();
-            QString cmd = QString("seek %1 absolute").arg(seekTo, 0, 'f', 3);
-            mpv_command_string(mpv, cmd.toUtf8().constData());
+        if (state.duration > 0) {
+            seekScheduler->seek(state.duration * value / controls->seekSlider->maximum(), false);
         }
     });
 
     // Volume slider
     connect(controls->volumeSlider, &QSlider::valueChanged, this, [this](int value) {
         if (!mpv) return;
-        QString volume = QString::number(value);
-        mpv_set_property_string(mpv, "volume", volume.toUtf8().constData());
-    });
-
-    // Position changed signal
-    connect(this, &MpvWidget::positionChanged, this, [this](double pos) {
-        if (!controls || !mpv || isSeekingManually) return;
-
-        double duration = 0;
-        mpv_get_property(mpv, "duration", MPV_FORMAT_DOUBLE, &duration);
-
-        if (duration > 0) {
-            int sliderPos = static_cast<int>((pos / duration) * controls->seekSlider->maximum());
-
-            controls->seekSlider->blockSignals(true);
-            controls->seekSlider->setValue(sliderPos);
-            controls->seekSlider->blockSignals(false);
-
-            // Update time label
-            QTime currentTime(0, 0, 0);
-            QTime totalTime(0, 0, 0);
-            currentTime = currentTime.addSecs(static_cast<int>(pos));
-            totalTime = totalTime.addSecs(static_cast<int>(duration));
-
-            QString timeText;
-            if (duration >= 3600) {
-                timeText = QString("%1 / %2")
-                .arg(currentTime.toString("hh:mm:ss"))
-                .arg(totalTime.toString("hh:mm:ss"));
-            } else {
-                timeText = QString("%1 / %2")
-                .arg(currentTime.toString("mm:ss"))
-                .arg(totalTime.toString("mm:ss"));
-            }
-
-            controls->timeLabel->setText(timeText);
-        }
-    });
-
-    // Duration changed signal
-    connect(this, &MpvWidget::durationChanged, this, [this](double duration) {
-        if (!controls || !mpv) return;
-
-        if (duration > 0) {
-            controls->seekSlider->setMaximum(1000);
-        }
+        mpvSetAsync(mpv, "volume", double(value));
     });
 }
 
-void MpvWidget::initializeGL()
+void MpvWidget::adoptCore()
 {
-    setlocale(LC_NUMERIC, "C");
+    if (mpv || !coreFuture.valid())
+        return;
 
-    mpv = mpv_create();
+    mpv = coreFuture.get();
     if (!mpv)
-        qFatal("Could not create MPV instance");
+        qFatal("Could not initialize mpv");
+
+    // Options handed in after construction are applied at runtime
+    for (const auto &opt : std::as_const(extraOptions))
+        mpvSetOption(mpv, opt.first.constData(), opt.second);
+    extraOptions.clear();
+
+    // Registered before the event thread starts; initial values follow as events
+    static_assert(std::size(observedProperties) == ObserveLast, "one row per MpvObserveId");
+    static_assert(observedIdsInOrder(), "observedProperties rows must be in MpvObserveId order");
+    for (const ObservedProperty &property : observedProperties)
+        mpv_observe_property(mpv, property.id, property.name, property.format);
+    // Decoder options are picked per file once its tracks are known
+    mpv_hook_add(mpv, HookPreloaded, "on_preloaded", 0);
+
+    seekScheduler->setHandle(mpv);
+    shuttle->setHandle(mpv);
+    grabber->setHandle(mpv);
+    setTimePosObserved(power == PowerState::Active);
+    updateDisplayFps();
+
+    // Events are drained on a dedicated thread; the GUI only sees decoded updates
+    eventThread = new MpvEventThread(mpv, this);
+    eventThread->setFramePool(grabber->pool());
+    connect(eventThread, &MpvEventThread::updatesAvailable,
+            this, &MpvWidget::processMpvEvents, Qt::QueuedConnection);
+    eventThread->start();
 
-    auto setOpt = [this](const char *name, const char *value) {
-        int r = mpv_set_option_string(mpv, name, value);
-        if (r < 0) {
-            qWarning() << "Failed to set mpv option" << name << ":" << mpv_error_string(r);
-        }
-    };
-
-    // Use libmpv VO to avoid spawning a separate window; rendered via the OpenGL callback
-    setOpt("vo", "libmpv");
-    // Use safe hardware decoding; avoid forcing CUDA on systems without it
-    setOpt("hwdec", "auto-safe");
-    // Standard player behavior: scale to window with letterboxing/pillarboxing
-    setOpt("keepaspect", "yes");
-    setOpt("keepaspect-window", "yes");
-    setOpt("video-unscaled", "no");
-    setOpt("panscan", "0");
-    int initStatus = mpv_initialize(mpv);
-    if (initStatus < 0) {
-        qFatal("Could not initialize mpv: %s", mpv_error_string(initStatus));
-    }
-
-    mpv_opengl_init_params gl_init = {
-        .get_proc_address = [](void *, const char *name) -> void * {
-            return reinterpret_cast<void *>(QOpenGLContext::currentContext()->getProcAddress(name));
-        },
-        .get_proc_address_ctx = nullptr
-    };
-
-    mpv_render_param params[] = {
-        {MPV_RENDER_PARAM_API_TYPE, const_cast<char*>(MPV_RENDER_API_TYPE_OPENGL)},
-        {MPV_RENDER_PARAM_OPENGL_INIT_PARAMS, &gl_init},
-        {MPV_RENDER_PARAM_INVALID, nullptr}
-    };
-
-    if (mpv_render_context_create(&mpv_gl, mpv, params) < 0)
-        qFatal("Failed to create MPV render context");
-
-    mpv_render_context_set_update_callback(mpv_gl, on_mpv_redraw, this);
-
-    mpv_observe_property(mpv, 1, "time-pos", MPV_FORMAT_DOUBLE);
-    mpv_observe_property(mpv, 2, "duration", MPV_FORMAT_DOUBLE);
-
-    mpv_set_wakeup_callback(mpv, on_mpv_events, this);
-
-    // Set initial volume once on startup
-    mpv_set_property_string(mpv, "volume", "50");
     if (controls && controls->volumeSlider) {
         controls->volumeSlider->setValue(50);
     }
-
-    // If a file/URL was dropped before mpv initialized, start it now
-    if (!pendingPlayUrl.isEmpty()) {
-        play(pendingPlayUrl);
-        pendingPlayUrl.clear();
+    setupControlConnections();
+    applyMemoryLimits();
+
+    // Nothing to wait for without a video output
+    if (audioOnlyForced) {
+        mpv_set_property_string(mpv, "vid", "no");
+        enterAudioOnly();
+        onVideoAttached();
+        return;
     }
+    video->attach(mpv);
 }
 
-void MpvWidget::paintGL()
+void MpvWidget::setupVideo(VideoBackend::Mode mode)
 {
-    if (!mpv_gl)
-        return;
-
-    int fb_w = static_cast<int>(devicePixelRatio() * width());
-    int fb_h = static_cast<int>(devicePixelRatio() * height());
-
-    glViewport(0, 0, fb_w, fb_h);
-
-    mpv_opengl_fbo fbo = {
-        .fbo = static_cast<int>(defaultFramebufferObject()),
-        .w   = fb_w,
-        .h   = fb_h,
-        .internal_format = 0,
-    };
+    video = VideoBackend::create(mode, this);
+    layout()->addWidget(video->widget());
+    video->widget()->lower();
+    video->widget()->show();
+    video->setFrameStats(frameStatsEnabled ? &frameStats : nullptr);
+
+    connect(video, &VideoBackend::attached, this, &MpvWidget::onVideoAttached);
+    connect(video, &VideoBackend::framePresented, this, &MpvWidget::onFramePresented);
+    connect(video, &VideoBackend::failed, this, &MpvWidget::onVideoFailed, Qt::QueuedConnection);
+}
 
-    int flip_y = 1;
-    int size[2] = { fb_w, fb_h };
+void MpvWidget::onVideoFailed()
+{
+    if (video->mode() == VideoBackend::Software)
+        qFatal("No usable video output");
+
+    // GL came up but mpv could not use it; the CPU renderer needs nothing from it
+    qWarning() << "Falling back to software rendering";
+    VideoBackend *old = video;
+    layout()->removeWidget(old->widget());
+    old->widget()->hide();
+    old->deleteLater();
+    old->widget()->deleteLater();
+
+    setupVideo(VideoBackend::Software);
+    if (mpv)
+        video->attach(mpv);
+}
 
-    mpv_render_param params[] = {
-        {MPV_RENDER_PARAM_OPENGL_FBO, &fbo},
-        {MPV_RENDER_PARAM_FLIP_Y, &flip_y},
-        {MPV_RENDER_PARAM_SW_SIZE, size},
-        {MPV_RENDER_PARAM_INVALID, nullptr}
-    };
+void MpvWidget::onVideoAttached()
+{
+    // Leaving audio-only mode attaches again
+    if (!initializedSent) {
+        initializedSent = true;
+        emit initialized();
+    }
 
-    mpv_render_context_render(mpv_gl, params);
+    // If a file/URL was dropped before the render context existed, start it now
+    if (!pendingPlayUrl.isEmpty()) {
+        play(pendingPlayUrl);
+        pendingPlayUrl.clear();
+    }
 }
 
-void MpvWidget::resizeGL(int w, int h)
+void MpvWidget::onFramePresented()
 {
-    Q_UNUSED(w)
-    Q_UNUSED(h)
+    seekScheduler->framePresented();
+    shuttle->framePresented();
 
-    if (mpv_gl)
-        mpv_render_context_set_update_callback(mpv_gl, on_mpv_redraw, this);
+    if (traceFirstFrame) {
+        traceFirstFrame = false;
+        StartupTrace::mark(StartupTrace::FirstFrame);
+    }
 
-    update();
+    if (transitionArmed) {
+        const qint64 latencyUs = (frameClock.nsecsElapsed() - transitionStartNs) / 1000;
+        transitionLatency.add(latencyUs);
+        transitionArmed = false;
+        transitionStartNs = -1;
+
+        const double fps = state.containerFps;
+        qInfo().noquote() << QString("Playlist transition: %1 ms to first frame (frame interval %2 ms)")
+                                 .arg(formatMs(latencyUs))
+                                 .arg(fps > 0 ? QString::number(1000.0 / fps, 'f', 2) : QStringLiteral("?"));
+    }
 }
 
 void MpvWidget::play(const QString &url)
 {
-    if (!mpv) {
+    // vo=libmpv needs the render context before a file is opened
+    if (!mpv || (!video->isAttached() && !audioOnly)) {
         pendingPlayUrl = url;
-        qWarning() << "MPV not initialized yet; queued" << url;
         return;
     }
 
-    // If this is a new file, add to playlist
-    if (currentIndex == -1 || playlist.isEmpty() || playlist.value(currentIndex) != url) {
-        playlist << url;
-        currentIndex = playlist.size() - 1;
-    }
+    // New URLs are appended; known ones just become current
+    playlist.setCurrentIndex(playlist.append(url));
+    schedulePlaylistSave();
 
-    QByteArray ba = url.toUtf8();
-    const char *cmd[] = {"loadfile", ba.constData(), nullptr};
-    int status = mpv_command(mpv, cmd);
+    // Replacing also drops whatever was prefetched behind the old item
+    prefetchedIndex = -1;
+    transitionStartNs = -1;
+    replacingFile = true;
+
+    prefillFromProbe(url);
+
+    const CacheProfile &profile = cacheProfiles.forUrl(url);
+    int status = loadFile(url, "replace", cacheOptions(profile), 0);
+    if (status >= 0)
+        setActiveCacheProfile(profile);
     if (status < 0) {
+        replacingFile = false;
         qWarning() << "Failed to load" << url << ":" << mpv_error_string(status);
         return;
     }
 
-    // Always start playing (even if previous item was paused)
-    mpv_set_property_string(mpv, "pause", "no");
-    isPaused = false;
-    // show pause icon to reflect playing state
-    if (controls && controls->playButton) {
-        controls->playButton->setIcon(QIcon(":/icons/pause.svg"));
+    // Always start playing (even if previous item was paused), forward
+    shuttle->release();
+    mpvSetAsync(mpv, "pause", false);
+    emit stateChanged();
+}
+
+int MpvWidget::enqueue(const QStringList &urls)
+{
+    const int added = playlist.append(urls);
+    if (added > 0) {
+        schedulePlaylistSave();
+        queuePrefetch();
+        emit stateChanged();
     }
+    return added;
+}
+
+void MpvWidget::open(const QStringList &inputs)
+{
+    // Returns at once; only the newest open takes over playback
+    playFirstRequest = ingest->add(inputs);
+}
+
+void MpvWidget::seek(double seconds, bool relative)
+{
+    if (!mpv)
+        return;
+
+    double target = relative ? state.timePos + seconds : seconds;
+    if (state.duration > 0)
+        target = qBound(0.0, target, state.duration);
+    seekScheduler->seek(qMax(0.0, target), true);
+}
+
+void MpvWidget::setPaused(bool paused)
+{
+    if (!mpv)
+        return;
+
+    // A backward frame step leaves play-dir reversed; playing means forward at 1x
+    if (!paused)
+        shuttle->release();
+    mpvSetAsync(mpv, "pause", paused);
+}
+
+bool MpvWidget::captureFrame()
+{
+    // Audio-only files have no frame to grab
+    if (!mpv || audioOnly)
+        return false;
+    return grabber->capture(captureName());
+}
+
+void MpvWidget::captureBurst(int count, int intervalMs)
+{
+    if (mpv && !audioOnly)
+        grabber->captureBurst(captureName(), count, intervalMs);
+}
+
+QString MpvWidget::captureName() const
+{
+    const QString url = playlist.currentIndex() >= 0 ? playlist.url(playlist.currentIndex()) : QString();
+    QString name = QFileInfo(QUrl(url).isLocalFile() ? QUrl(url).toLocalFile() : QUrl(url).path()).completeBaseName();
+    if (name.isEmpty())
+        name = QStringLiteral("frame");
+
+    const QTime position = QTime(0, 0).addMSecs(static_cast<int>(state.timePos * 1000));
+    return name + '-' + position.toString("HH-mm-ss-zzz");
 }
 
 void MpvWidget::playNext()
 {
     if (playlist.isEmpty()) return;
 
-    currentIndex++;
-    if (currentIndex >= playlist.size()) currentIndex = 0;
-
-    play(playlist[currentIndex]);
+    playlist.setCurrentIndex(playlist.nextIndex());
+    play(playlist.url(playlist.currentIndex()));
 }
 
 void MpvWidget::playPrev()
 {
     if (playlist.isEmpty()) return;
 
-    currentIndex--;
-    if (currentIndex < 0) currentIndex = playlist.size() - 1;
+    playlist.setCurrentIndex(playlist.previousIndex());
+    play(playlist.url(playlist.currentIndex()));
+}
+
+void MpvWidget::queuePrefetch()
+{
+    if (!mpv || !autoAdvance || playlist.size() < 2)
+        return;
+
+    const int next = playlist.nextIndex();
+    if (next == prefetchedIndex)
+        return;
+
+    // A stale prefetch sits right behind the current entry
+    if (prefetchedIndex >= 0) {
+        const char *remove[] = {"playlist-remove", "1", nullptr};
+        mpv_command_async(mpv, AsyncPlaylistRemove, remove);
+    }
+
+    // The entry carries its own cache options; the current file keeps its own
+    const QString url = playlist.url(next);
+    if (loadFile(url, "append", cacheOptions(cacheProfiles.forUrl(url)), AsyncPrefetch) >= 0)
+        prefetchedIndex = next;
+}
+
+void MpvWidget::onStartFile()
+{
+    if (replacingFile) {
+        replacingFile = false;
+        return;
+    }
+
+    if (prefetchedIndex < 0)
+        return;
+
+    // mpv moved on to the prefetched entry by itself; drop the finished one
+    playlist.setCurrentIndex(prefetchedIndex);
+    prefetchedIndex = -1;
+    setActiveCacheProfile(cacheProfiles.forUrl(playlist.url(playlist.currentIndex())));
+    // The budget may have shrunk since the entry was queued
+    applyDemuxerLimits();
+    schedulePlaylistSave();
+    emit stateChanged();
+
+    const char *remove[] = {"playlist-remove", "0", nullptr};
+    mpv_command_async(mpv, AsyncPlaylistRemove, remove);
+}
+
+void MpvWidget::setPlaylistFile(const QString &path)
+{
+    playlistFile = path;
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QElapsedTimer timer;
+    timer.start();
+    if (playlist.load(path)) {
+        qInfo() << "Restored" << playlist.size() << "playlist entries in" << timer.elapsed() << "ms";
+    }
+}
 
-    play(playlist[currentIndex]);
+void MpvWidget::schedulePlaylistSave()
+{
+    if (!playlistFile.isEmpty())
+        playlistSaveTimer->start();
 }
 
 
 void MpvWidget::resizeEvent(QResizeEvent *event)
 {
-    QOpenGLWidget::resizeEvent(event);
+    QWidget::resizeEvent(event);
     repositionControls();
 }
 
+void MpvWidget::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+
+    // Minimizing changes the window's state, not this widget's visibility;
+    // moving to another monitor may change the refresh rate
+    if (!windowFiltered) {
+        window()->installEventFilter(this);
+        windowFiltered = true;
+        if (QWindow *handle = window()->windowHandle()) {
+            connect(handle, &QWindow::screenChanged, this, &MpvWidget::trackScreen);
+            trackScreen(handle->screen());
+        }
+    }
+    updatePowerState();
+}
+
+void MpvWidget::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    updatePowerState();
+}
+
 bool MpvWidget::eventFilter(QObject *obj, QEvent *event)
 {
+    if (obj == window() && event->type() == QEvent::WindowStateChange)
+        updatePowerState();
+
     if (obj == this) {
         if (event->type() == QEvent::Move ||
             event->type() == QEvent::Resize ||
@@ -393,41 +859,44 @@ bool MpvWidget::eventFilter(QObject *obj, QEvent *event)
             }
     }
 
-    return QOpenGLWidget::eventFilter(obj, event);
+    return QWidget::eventFilter(obj, event);
 }
 
 void MpvWidget::mouseMoveEvent(QMouseEvent *event)
 {
-    QOpenGLWidget::mouseMoveEvent(event);
+    QWidget::mouseMoveEvent(event);
 
     // Show cursor and controls
-    setCursor(Qt::ArrowCursor);
+    if (cursor().shape() != Qt::ArrowCursor)
+        setCursor(Qt::ArrowCursor);
 
     if (controls) {
         controls->fadeIn();
         controls->resetHideTimer();
+        // Moves come faster than the refresh cap
+        scheduleControlsRefresh();
     }
 
-    // Restart cursor hide timer
-    if (cursorHideTimer) {
-        cursorHideTimer->stop();
-        cursorHideTimer->start();
-    }
+    // Only a timestamp per move; the timer itself is armed once
+    lastMouseActivity.start();
+    if (!cursorHideTimer->isActive())
+        cursorHideTimer->start(kCursorHideMs);
 }
 
 void MpvWidget::enterEvent(QEnterEvent *event)
 {
-    QOpenGLWidget::enterEvent(event);
+    QWidget::enterEvent(event);
     setCursor(Qt::ArrowCursor);
 
     if (controls) {
         controls->fadeIn();
+        refreshControls();
     }
 }
 
 void MpvWidget::leaveEvent(QEvent *event)
 {
-    QOpenGLWidget::leaveEvent(event);
+    QWidget::leaveEvent(event);
     if (cursorHideTimer) {
         cursorHideTimer->stop();
     }
@@ -436,7 +905,7 @@ void MpvWidget::leaveEvent(QEvent *event)
 
 void MpvWidget::mouseDoubleClickEvent(QMouseEvent *event)
 {
-    QOpenGLWidget::mouseDoubleClickEvent(event);
+    QWidget::mouseDoubleClickEvent(event);
 
     if (window()->windowState() & Qt::WindowFullScreen) {
         window()->showNormal();
@@ -461,11 +930,51 @@ void MpvWidget::keyPressEvent(QKeyEvent *event)
             repositionControls();
         }
     } else if (event->key() == Qt::Key_Space) {
+        shuttle->release();
         if (controls && controls->playButton) {
             controls->playButton->click();
         }
+    } else if (event->key() == Qt::Key_I) {
+        toggleStatsOverlay();
+    } else if (event->key() == Qt::Key_S) {
+        if (event->modifiers() & Qt::ShiftModifier)
+            captureBurst(kBurstFrames, kBurstIntervalMs);
+        else
+            captureFrame();
+    } else if (event->key() == Qt::Key_A) {
+        setAudioOnly(!audioOnlyForced);
+    } else if (event->key() == Qt::Key_K) {
+        if (!event->isAutoRepeat()) {
+            shuttleHeld = true;
+            shuttle->stop();
+        }
+    } else if (event->key() == Qt::Key_L) {
+        if (shuttleHeld)
+            shuttle->step(1);
+        else if (!event->isAutoRepeat())
+            shuttle->forward();
+    } else if (event->key() == Qt::Key_J) {
+        if (shuttleHeld)
+            shuttle->step(-1);
+        else if (!event->isAutoRepeat())
+            shuttle->reverse();
+    } else if (event->key() == Qt::Key_Period) {
+        shuttle->step(1);
+    } else if (event->key() == Qt::Key_Comma) {
+        shuttle->step(-1);
+    } else if (event->key() == Qt::Key_Right) {
+        shuttle->jumpKeyframe(1);
+    } else if (event->key() == Qt::Key_Left) {
+        shuttle->jumpKeyframe(-1);
     }
-    QOpenGLWidget::keyPressEvent(event);
+    QWidget::keyPressEvent(event);
+}
+
+void MpvWidget::keyReleaseEvent(QKeyEvent *event)
+{
+    if (event->key() == Qt::Key_K && !event->isAutoRepeat())
+        shuttleHeld = false;
+    QWidget::keyReleaseEvent(event);
 }
 
 //add drag and drop functionality
@@ -487,65 +996,818 @@ void MpvWidget::dragMoveEvent(QDragMoveEvent *event)
 
 void MpvWidget::dropEvent(QDropEvent *event)
 {
-    QList<QUrl> urls = event->mimeData()->urls();
-    if (urls.isEmpty())
+    QStringList inputs;
+    for (const QUrl &url : event->mimeData()->urls()) {
+        // Local files and folders by path, anything else as a URL
+        const QString path = url.toLocalFile();
+        inputs << (path.isEmpty() ? url.toString() : path);
+    }
+    if (inputs.isEmpty())
         return;
 
-    QString filePath = urls.first().toLocalFile();
-    if (!filePath.isEmpty()) {
-        if (mpv) {
-            play(filePath);            // local file
-        } else {
-            pendingPlayUrl = filePath; // wait for mpv init
+    open(inputs);
+    event->acceptProposedAction();
+}
+void MpvWidget::processMpvEvents()
+{
+    if (!eventThread)
+        return;
+
+    eventThread->acknowledge();
+
+    MpvUpdate update;
+    while (eventThread->next(update)) {
+        switch (update.kind) {
+        case MpvUpdate::Property:
+            applyProperty(update);
+            break;
+
+        case MpvUpdate::CommandReply:
+            if (update.id == AsyncSeek)
+                seekScheduler->commandReply(update.error);
+            else if (update.id == AsyncScreenshot)
+                grabber->commandReply(update.error, static_cast<int>(update.number));
+            else if (update.id == AsyncVideoReload && update.error < 0)
+                qWarning() << "Could not reload the video decoder:" << mpv_error_string(update.error);
+            break;
+
+        case MpvUpdate::PropertyReply:
+            if (update.id == AsyncTimePos && update.error >= 0 && update.available) {
+                state.timePos = update.number;
+                emit positionChanged(state.timePos);
+                positionMoved = true;
+                scheduleControlsRefresh();
+            }
+            break;
+
+        case MpvUpdate::Hook:
+            if (update.id == HookPreloaded)
+                onPreloaded();
+            mpv_hook_continue(mpv, update.hookId);
+            break;
+
+        case MpvUpdate::SetPropertyReply:
+            qWarning() << "mpv rejected a property change:" << mpv_error_string(update.error);
+            break;
+
+        case MpvUpdate::PlaybackRestart:
+            // A seek while paused: position is not observed, so read it once
+            if (!timePosObserved)
+                mpv_get_property_async(mpv, AsyncTimePos, "time-pos", MPV_FORMAT_DOUBLE);
+            seekScheduler->playbackRestarted();
+            if (transitionStartNs >= 0)
+                transitionArmed = true;
+            break;
+
+        case MpvUpdate::StartFile:
+            onStartFile();
+            break;
+
+        case MpvUpdate::FileLoaded:
+            StartupTrace::mark(StartupTrace::FileLoaded);
+            onFileLoaded();
+            cacheStalls = 0;
+            rebufferMs = 0;
+            stallClock.invalidate();
+            traceFirstFrame = true;
+            audioOnlyTitle = mpvGet<QString>(mpv, "media-title");
+            if (audioOnly)
+                update();
+            thumbnailer->setSource(playlist.url(playlist.currentIndex()));
+            startKeyframeIndex(playlist.url(playlist.currentIndex()));
+            queuePrefetch();
+            break;
+
+        case MpvUpdate::EndFile:
+            seekScheduler->fileEnded();
+            // Played to the end: start from the beginning next time
+            if (update.endReason == MPV_END_FILE_REASON_EOF)
+                storeProbe(0);
+            probeReady = false;
+            if (update.endReason == MPV_END_FILE_REASON_EOF || update.endReason == MPV_END_FILE_REASON_ERROR)
+                emit playbackEnded(update.endReason == MPV_END_FILE_REASON_ERROR);
+
+            // With a prefetched entry mpv continues on its own; time the switch
+            if (update.endReason == MPV_END_FILE_REASON_EOF && prefetchedIndex >= 0) {
+                transitionStartNs = frameClock.nsecsElapsed();
+                transitionArmed = false;
+                break;
+            }
+
+            // Only auto-advance on natural EOF, not on STOP (which fires when we manually replace a file)
+            if (autoAdvance && update.endReason == MPV_END_FILE_REASON_EOF && playlist.size() > 1) {
+                playNext();
+            }
+            break;
+
+        default:
+            break;
         }
-        event->acceptProposedAction();
+    }
+}
+
+void MpvWidget::applyProperty(const MpvUpdate &update)
+{
+    if (update.id == 0 || update.id > std::size(observedProperties))
         return;
+
+    if ((this->*observedProperties[update.id - 1].apply)(update)) {
+        emit stateChanged();
+        scheduleControlsRefresh();
     }
+}
 
-    // Fallback: try remote URL directly
-    const QString url = urls.first().toString();
-    if (!url.isEmpty()) {
-        if (mpv) {
-            play(url);
-        } else {
-            pendingPlayUrl = url;
+bool MpvWidget::onTimePos(const MpvUpdate &update)
+{
+    // Drop rates are judged against time actually played: pauses add
+    // nothing and seeks show up as jumps, which are left out
+    if (update.available && decodeLastTimePos >= 0) {
+        const double advance = update.number - decodeLastTimePos;
+        if (advance > 0 && advance < kMaxPlayAdvanceSeconds)
+            decodePlayedSeconds += advance;
+    }
+    decodeLastTimePos = update.available ? update.number : -1;
+
+    state.timePos = update.available ? update.number : 0;
+    if (update.available)
+        emit positionChanged(state.timePos);
+
+    // Every frame moves it; listeners hear of it at the refresh rate
+    positionMoved = true;
+    scheduleControlsRefresh();
+    return false;
+}
+
+bool MpvWidget::onDuration(const MpvUpdate &update)
+{
+    // Keep a duration taken from the probe cache until the file reports one
+    if (!update.available && probePrefilled)
+        return false;
+    const double duration = update.available ? update.number : 0;
+    if (duration == state.duration)
+        return false;
+    state.duration = duration;
+    if (update.available) {
+        emit durationChanged(state.duration);
+        if (probeReady && !qFuzzyCompare(probeInfo.duration, state.duration)) {
+            probeInfo.duration = state.duration;
+            probeStoreTimer->start();
         }
-        event->acceptProposedAction();
     }
+    return true;
 }
-void MpvWidget::processMpvEvents()
+
+bool MpvWidget::onPause(const MpvUpdate &update)
+{
+    const bool paused = update.available && update.number != 0;
+    if (paused == state.paused)
+        return false;
+    state.paused = paused;
+    updatePowerState();
+    return true;
+}
+
+bool MpvWidget::onPausedForCache(const MpvUpdate &update)
+{
+    const bool stalled = update.available && update.number != 0;
+    if (stalled == state.pausedForCache)
+        return false;
+    if (stalled) {
+        ++cacheStalls;
+        stallClock.start();
+    } else if (stallClock.isValid()) {
+        rebufferMs += stallClock.elapsed();
+        stallClock.invalidate();
+    }
+    state.pausedForCache = stalled;
+    return true;
+}
+
+bool MpvWidget::onCacheState(const MpvUpdate &update)
+{
+    // mpv only reports it when something in it moved
+    state.setCacheState(update.node);
+    return true;
+}
+
+bool MpvWidget::onCacheDuration(const MpvUpdate &update)
+{
+    const double cacheDuration = update.available ? update.number : 0;
+    if (cacheDuration == state.cacheDuration)
+        return false;
+    state.cacheDuration = cacheDuration;
+    return true;
+}
+
+bool MpvWidget::onTrackList(const MpvUpdate &update)
+{
+    QList<TrackInfo> tracks = PlayerState::parseTrackList(update.node);
+    if (tracks.isEmpty() && probePrefilled)
+        return false;
+    state.tracks = std::move(tracks);
+    if (probeReady && !state.tracks.isEmpty()) {
+        probeInfo.tracks = state.tracks;
+        probeStoreTimer->start();
+    }
+    return true;
+}
+
+bool MpvWidget::onChapterList(const MpvUpdate &update)
+{
+    QList<ChapterInfo> chapters = PlayerState::parseChapterList(update.node);
+    if (chapters.isEmpty() && probePrefilled)
+        return false;
+    state.chapters = std::move(chapters);
+    if (probeReady && !state.chapters.isEmpty()) {
+        probeInfo.chapters = state.chapters;
+        probeStoreTimer->start();
+    }
+    return true;
+}
+
+bool MpvWidget::onContainerFps(const MpvUpdate &update)
+{
+    const double fps = update.available ? update.number : 0;
+    if (fps == state.containerFps)
+        return false;
+    state.containerFps = fps;
+    return true;
+}
+
+bool MpvWidget::onDecoderDrops(const MpvUpdate &update)
+{
+    // Tuning state only, nothing shown
+    if (!decodeTuning || !update.available)
+        return false;
+
+    // A reloaded decoder counts from zero again
+    const qint64 drops = static_cast<qint64>(update.number);
+    if (drops < decodeDropBase)
+        decodeDropBase = 0;
+
+    if (!decodeTuner.reportDrops(decodeInput, drops - decodeDropBase, decodePlayedSeconds))
+        return false;
+
+    // Options are read when a decoder is created; reload this file's decoder
+    // so it recovers now, not only the next file of its class
+    decodeConfig = decodeTuner.choose(decodeInput);
+    decodeTuner.apply(mpv, decodeConfig);
+    decodeDropBase = drops;
+    decodePlayedSeconds = 0;
+    const char *reload[] = {"video-reload", nullptr};
+    mpv_command_async(mpv, AsyncVideoReload, reload);
+
+    qInfo().noquote() << "Decoder dropping frames on" << decodeInput.classKey()
+                      << "- reloading with" << decodeConfig.describe();
+    return false;
+}
+
+void MpvWidget::onPreloaded()
+{
+    // mpv is waiting in the hook, so this read sees the opened file before
+    // any decoder or video output exists for it
+    mpv_node node;
+    if (mpv_get_property(mpv, "track-list", MPV_FORMAT_NODE, &node) < 0)
+        return;
+    const QVariant trackList = mpvNodeToVariant(&node);
+    mpv_free_node_contents(&node);
+
+    selectVideoOutput(trackList);
+    tuneDecoder(trackList);
+}
+
+void MpvWidget::tuneDecoder(const QVariant &trackList)
+{
+    // Options outlive the file; back to the user's or mpv's defaults once
+    // tuning is off
+    if (!decodeTuning) {
+        if (decodeConfigApplied && !audioOnly) {
+            decodeTuner.apply(mpv, DecodeConfig());
+            decodeConfigApplied = false;
+        }
+        decodeConfig = DecodeConfig();
+        return;
+    }
+    if (audioOnly)
+        return;
+
+    const bool live = CacheProfiles::classify(playlist.url(playlist.currentIndex())) == CacheProfiles::Live;
+    decodeInput = DecodeInput::fromTrackList(trackList, live);
+    decodeConfig = decodeTuner.choose(decodeInput);
+    decodeTuner.apply(mpv, decodeConfig);
+    decodeConfigApplied = true;
+}
+
+void MpvWidget::selectVideoOutput(const QVariant &trackList)
+{
+    bool hasVideo = false;
+    bool hasAudio = false;
+    for (const TrackInfo &track : PlayerState::parseTrackList(trackList)) {
+        if (track.type == QLatin1String("video") && !track.albumart)
+            hasVideo = true;
+        else if (track.type == QLatin1String("audio"))
+            hasAudio = true;
+    }
+
+    if (audioOnlyForced || (hasAudio && !hasVideo)) {
+        // Cover art alone would keep a video output busy for one still image
+        if (!audioOnlyForced)
+            mpv_set_property_string(mpv, "file-local-options/vid", "no");
+        enterAudioOnly();
+    } else if (hasVideo) {
+        // Attached before the hook returns, so the video output finds it
+        leaveAudioOnly();
+    }
+}
+
+void MpvWidget::setAudioOnly(bool enabled)
 {
+    if (enabled == audioOnlyForced)
+        return;
+
+    audioOnlyForced = enabled;
     if (!mpv)
         return;
 
-    while (true) {
-        mpv_event *event = mpv_wait_event(mpv, 0);
-        if (event->event_id == MPV_EVENT_NONE)
-            break;
+    if (enabled) {
+        // Video goes first so the render context is no longer in use
+        mpv_set_property_string(mpv, "vid", "no");
+        enterAudioOnly();
+    } else if (state.hasVideo()) {
+        // A track switch, not a reload: playback carries on where it is
+        leaveAudioOnly();
+        mpv_set_property_string(mpv, "vid", "auto");
+    } else {
+        // Stays audio-only for this file; the next one decides for itself
+        mpv_set_property_string(mpv, "vid", "auto");
+        mpv_set_property_string(mpv, "file-local-options/vid", "no");
+    }
+    emit stateChanged();
+}
 
-        if (event->event_id == MPV_EVENT_PROPERTY_CHANGE) {
-            auto *prop = static_cast<mpv_event_property *>(event->data);
+void MpvWidget::enterAudioOnly()
+{
+    if (audioOnly)
+        return;
 
-            if (strcmp(prop->name, "time-pos") == 0 && prop->format == MPV_FORMAT_DOUBLE && prop->data) {
-                double pos = *static_cast<double *>(prop->data);
-                emit positionChanged(pos);
-            }
+    audioOnly = true;
+    video->detach();
+    video->widget()->hide();
+    update();
+    emit stateChanged();
+}
 
-            if (strcmp(prop->name, "duration") == 0 && prop->format == MPV_FORMAT_DOUBLE && prop->data) {
-                double dur = *static_cast<double *>(prop->data);
-                emit durationChanged(dur);
-            }
-        }
+void MpvWidget::leaveAudioOnly()
+{
+    if (!audioOnly)
+        return;
 
-        if (event->event_id == MPV_EVENT_END_FILE) {
-            auto *end = static_cast<mpv_event_end_file *>(event->data);
-            if (!end)
-                continue;
+    audioOnly = false;
+    video->widget()->show();
+    video->widget()->lower();
+    video->attach(mpv);
+    emit stateChanged();
+}
 
-            // Only auto-advance on natural EOF, not on STOP (which fires when we manually replace a file)
-            if (end->reason == MPV_END_FILE_REASON_EOF && playlist.size() > 1) {
-                playNext();
-            }
+void MpvWidget::paintEvent(QPaintEvent *event)
+{
+    if (!audioOnly) {
+        QWidget::paintEvent(event);
+        return;
+    }
+
+    // Drawn once per resize or file, never per frame
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(16, 16, 16));
+
+    QFont font = painter.font();
+    font.setPointSizeF(font.pointSizeF() * 1.6);
+    painter.setFont(font);
+    painter.setPen(QColor(230, 230, 230));
+    const QRect text = rect().adjusted(40, 0, -40, -rect().height() / 4);
+    painter.drawText(text, Qt::AlignCenter | Qt::TextWordWrap,
+                     audioOnlyTitle.isEmpty() ? QStringLiteral("Audio only") : audioOnlyTitle);
+}
+
+void MpvWidget::scheduleControlsRefresh()
+{
+    // Hidden controls are brought up to date when the window comes back;
+    // position still goes out to stateChanged() listeners
+    if (controlsRefreshTimer->isActive() || (power == PowerState::Hidden && !positionMoved))
+        return;
+
+    qreal hz = kMaxControlsRefreshHz;
+    if (screen() && screen()->refreshRate() > 0)
+        hz = qMin(hz, screen()->refreshRate());
+
+    controlsRefreshTimer->start(qMax(1, static_cast<int>(1000.0 / hz)));
+}
+
+void MpvWidget::refreshControls()
+{
+    // Hidden controls catch up when they are shown again
+    if (!controls || !controls->isVisible())
+        return;
+
+    controls->showState(state, isSeekingManually);
+}
+
+void MpvWidget::showSeekPreview(double fraction, int x)
+{
+    if (state.duration <= 0) {
+        seekPreview->hide();
+        return;
+    }
+
+    previewSeconds = fraction * state.duration;
+    previewX = x;
+    updateSeekPreview(previewSeconds, thumbnailer->request(previewSeconds, state.duration));
+}
+
+void MpvWidget::updateSeekPreview(double seconds, const QImage &image)
+{
+    Q_UNUSED(seconds)
+
+    if (previewSeconds < 0)
+        return;
+
+    const QString format = state.duration >= 3600 ? QStringLiteral("hh:mm:ss") : QStringLiteral("mm:ss");
+    QString timeText = QTime(0, 0, 0).addSecs(static_cast<int>(previewSeconds)).toString(format);
+
+    // Chapter under the cursor; known from the probe cache before mpv reports it
+    for (auto it = state.chapters.crbegin(); it != state.chapters.crend(); ++it) {
+        if (it->time <= previewSeconds) {
+            if (!it->title.isEmpty())
+                timeText += QStringLiteral("  ") + it->title;
+            break;
         }
     }
+
+    if (image.isNull()) {
+        seekPreview->setPixmap(QPixmap());
+        seekPreview->setText(timeText);
+    } else {
+        // Time stamp burned into the bottom of the frame
+        QPixmap pixmap = QPixmap::fromImage(image);
+        QPainter painter(&pixmap);
+        const QRect band(0, pixmap.height() - 18, pixmap.width(), 18);
+        painter.fillRect(band, QColor(0, 0, 0, 150));
+        painter.setPen(Qt::white);
+        painter.drawText(band, Qt::AlignCenter, timeText);
+        painter.end();
+        seekPreview->setPixmap(pixmap);
+    }
+
+    seekPreview->adjustSize();
+
+    const QPoint barPos = controls->pos();
+    const int px = qBound(0, barPos.x() + previewX - seekPreview->width() / 2, width() - seekPreview->width());
+    seekPreview->move(px, barPos.y() - seekPreview->height() - 8);
+    seekPreview->show();
+    seekPreview->raise();
+}
+
+void MpvWidget::updatePowerState()
+{
+    const bool hidden = !isVisible() || window()->isMinimized();
+    const PowerState next = hidden ? PowerState::Hidden
+                          : state.paused ? PowerState::Paused
+                          : PowerState::Active;
+    if (next == power)
+        return;
+
+    const PowerState previous = power;
+    power = next;
+
+    if (previous == PowerState::Active) {
+        idleClock.start();
+        idleGuiWakeups = 0;
+        idleMpvEventsStart = eventThread ? eventThread->eventCount() : 0;
+    }
+
+    // time-pos is the only property that changes continuously
+    setTimePosObserved(power == PowerState::Active);
+
+    // Nothing is visible, so neither video nor UI timers need to run
+    const bool hiddenNow = power == PowerState::Hidden;
+    video->setSuspended(hiddenNow);
+    if (hiddenNow) {
+        cursorHideTimer->stop();
+        controls->cancelHideTimer();
+        controlsRefreshTimer->stop();
+        statsTimer->stop();
+    } else if (statsOverlay->isVisible()) {
+        statsTimer->start();
+    }
+
+    if (previous == PowerState::Hidden)
+        refreshControls();
+}
+
+void MpvWidget::setTimePosObserved(bool observed)
+{
+    if (!mpv || observed == timePosObserved)
+        return;
+
+    timePosObserved = observed;
+    if (observed) {
+        // mpv reports the current value right away on observe
+        const ObservedProperty &timePos = observedProperties[ObserveTimePos - 1];
+        mpv_observe_property(mpv, timePos.id, timePos.name, timePos.format);
+    } else {
+        mpv_unobserve_property(mpv, ObserveTimePos);
+    }
+}
+
+MpvWidget::IdleStats MpvWidget::idleStats() const
+{
+    IdleStats stats;
+    if (power == PowerState::Active || !idleClock.isValid())
+        return stats;
+
+    stats.idleMs = idleClock.elapsed();
+    stats.guiWakeups = idleGuiWakeups;
+    stats.mpvEvents = eventThread ? eventThread->eventCount() - idleMpvEventsStart : 0;
+    return stats;
+}
+
+void MpvWidget::trackScreen(QScreen *screen)
+{
+    disconnect(refreshRateConnection);
+    if (screen) {
+        refreshRateConnection = connect(screen, &QScreen::refreshRateChanged,
+                                        this, &MpvWidget::updateDisplayFps);
+    }
+    updateDisplayFps();
+}
+
+void MpvWidget::updateDisplayFps()
+{
+    if (!mpv || !screen())
+        return;
+
+    double fps = screen()->refreshRate();
+    if (fps <= 0 || qFuzzyCompare(fps, displayFps))
+        return;
+
+    displayFps = fps;
+
+    // Renamed in mpv 0.37; older builds only know the old name
+    if (mpv_set_property(mpv, "display-fps-override", MPV_FORMAT_DOUBLE, &fps) < 0
+        && mpv_set_property(mpv, "override-display-fps", MPV_FORMAT_DOUBLE, &fps) < 0) {
+        qWarning() << "Could not pass the display refresh rate to mpv";
+    }
+}
+
+int MpvWidget::loadFile(const QString &url, const char *flags, const QByteArray &options, quint64 replyId)
+{
+    // Named arguments: the position of "options" differs between mpv versions
+    const QByteArray file = url.toUtf8();
+    const char *keys[] = {"name", "url", "flags", "options"};
+    const char *strings[] = {"loadfile", file.constData(), flags, options.constData()};
+    mpv_node values[4];
+    for (int i = 0; i < 4; ++i) {
+        values[i].format = MPV_FORMAT_STRING;
+        values[i].u.string = const_cast<char *>(strings[i]);
+    }
+    mpv_node_list list{4, values, const_cast<char **>(keys)};
+    mpv_node cmd;
+    cmd.format = MPV_FORMAT_NODE_MAP;
+    cmd.u.list = &list;
+
+    if (replyId)
+        return mpv_command_node_async(mpv, replyId, &cmd);
+
+    mpv_node result;
+    const int status = mpv_command_node(mpv, &cmd, &result);
+    if (status >= 0)
+        mpv_free_node_contents(&result);
+    return status;
+}
+
+QByteArray MpvWidget::cacheOptions(const CacheProfile &profile) const
+{
+    // Per-file options: mpv restores its defaults once the file ends, so an
+    // entry queued behind another never opens with the other's settings
+    qint64 forward = profile.forwardBytes;
+    qint64 back = profile.backBytes;
+    if (budget.isEnabled()) {
+        forward = qMin(forward, budget.limit(MemoryUsage::DemuxerForward));
+        back = qMin(back, budget.limit(MemoryUsage::DemuxerBack));
+    }
+
+    const QByteArray readahead = QByteArray::number(profile.readaheadSeconds);
+    QByteArray options = "cache=" + QByteArray(profile.cache ? "yes" : "no")
+        + ",cache-secs=" + readahead
+        + ",demuxer-readahead-secs=" + readahead
+        + ",demuxer-max-bytes=" + QByteArray::number(forward)
+        + ",demuxer-max-back-bytes=" + QByteArray::number(back)
+        + ",cache-on-disk=" + QByteArray(profile.onDisk ? "yes" : "no");
+    if (profile.onDisk && !cacheProfiles.diskCacheDir.isEmpty()) {
+        QDir().mkpath(cacheProfiles.diskCacheDir);
+        // %length% quoting keeps commas in the path intact
+        const QByteArray dir = cacheProfiles.diskCacheDir.toUtf8();
+        options += ",demuxer-cache-dir=%" + QByteArray::number(dir.size()) + "%" + dir;
+    }
+    return options;
+}
+
+void MpvWidget::setActiveCacheProfile(const CacheProfile &profile)
+{
+    activeCacheProfile = profile.name;
+    profileForwardBytes = profile.forwardBytes;
+    profileBackBytes = profile.backBytes;
+}
+
+void MpvWidget::applyDemuxerLimits()
+{
+    // Nothing opened yet; the profile applied first takes the budget into account
+    if (profileForwardBytes <= 0)
+        return;
+
+    qint64 forward = profileForwardBytes;
+    qint64 back = profileBackBytes;
+    if (budget.isEnabled()) {
+        forward = qMin(forward, budget.limit(MemoryUsage::DemuxerForward));
+        back = qMin(back, budget.limit(MemoryUsage::DemuxerBack));
+    }
+
+    // Runtime changes reach the open demuxer too; it trims on its next pass.
+    // They last until the file ends, like the per-file options they override.
+    mpvSetOption(mpv, "demuxer-max-bytes", QByteArray::number(forward));
+    mpvSetOption(mpv, "demuxer-max-back-bytes", QByteArray::number(back));
+}
+
+void MpvWidget::setMemoryBudget(qint64 bytes)
+{
+    budget.setBudget(bytes);
+    if (budget.isEnabled())
+        memoryTimer->start();
+    else
+        memoryTimer->stop();
+
+    if (mpv)
+        applyMemoryLimits();
+}
+
+MemoryUsage MpvWidget::memoryUsage() const
+{
+    MemoryUsage usage;
+    usage.pools[MemoryUsage::DemuxerForward] = state.cacheForwardBytes;
+    usage.pools[MemoryUsage::DemuxerBack] = qMax<qint64>(0, state.cacheTotalBytes - state.cacheForwardBytes);
+    usage.pools[MemoryUsage::Thumbnails] = thumbnailer->memoryUsed();
+    usage.pools[MemoryUsage::Metadata] = probeCache->memoryUsage() + keyframes.size() * qint64(sizeof(double))
+        + probedMedia.size() * kProbedMediaBytes;
+    usage.pools[MemoryUsage::Playlist] = playlist.memoryUsage();
+    usage.pools[MemoryUsage::FrameGrabs] = grabber->pool()->bytesAllocated();
+    usage.sampleProcess();
+    return usage;
+}
+
+void MpvWidget::checkMemory()
+{
+    const MemoryUsage usage = memoryUsage();
+    if (!budget.report(usage, frameClock.elapsed()))
+        return;
+
+    qInfo().noquote() << QString("Memory: %1 of %2 MiB resident, limits now at level %3")
+                             .arg(usage.resident / (1024 * 1024))
+                             .arg(budget.budget() / (1024 * 1024))
+                             .arg(budget.level());
+    applyMemoryLimits();
+}
+
+void MpvWidget::applyMemoryLimits()
+{
+    applyDemuxerLimits();
+
+    // No budget: every pool back to its own default
+    if (!budget.isEnabled()) {
+        thumbnailer->setMemoryBudget(-1);
+        probeCache->setCapacity(ProbeCache::kDefaultCapacity);
+        keyframes.setCapacity(-1);
+        probedMediaCapacity = -1;
+        grabber->setMemoryLimit(-1);
+        return;
+    }
+
+    thumbnailer->setMemoryBudget(budget.limit(MemoryUsage::Thumbnails));
+
+    // Metadata: half for the probe cache, a quarter each for the keyframe
+    // index and background probe results.
+    // Entries vary in size; go by the current average
+    const qint64 metadata = budget.limit(MemoryUsage::Metadata);
+    const int entries = probeCache->size();
+    const qint64 entryBytes = entries > 0 ? qMax<qint64>(1, probeCache->memoryUsage() / entries) : 2048;
+    probeCache->setCapacity(static_cast<int>(qBound<qint64>(kMinProbeEntries, metadata / 2 / entryBytes, ProbeCache::kDefaultCapacity)));
+    keyframes.setCapacity(static_cast<int>(qMax<qint64>(kMinKeyframes, metadata / 4 / qint64(sizeof(double)))));
+    probedMediaCapacity = static_cast<int>(qMax<qint64>(kMinProbedMedia, metadata / 4 / kProbedMediaBytes));
+    trimProbedMedia();
+
+    grabber->setMemoryLimit(budget.limit(MemoryUsage::FrameGrabs));
+    // Grab buffers are only needed while grabbing
+    if (budget.level() > 0)
+        grabber->pool()->trim();
+}
+
+void MpvWidget::trimProbedMedia()
+{
+    if (probedMediaCapacity < 0)
+        return;
+
+    // Files probed first go first; they are probed again if added again
+    while (probedMedia.size() > probedMediaCapacity && !probedOrder.isEmpty())
+        probedMedia.remove(probedOrder.dequeue());
+}
+
+MpvWidget::StreamStats MpvWidget::streamStats() const
+{
+    StreamStats stats;
+    stats.stalls = cacheStalls;
+    stats.rebufferMs = rebufferMs + (stallClock.isValid() ? stallClock.elapsed() : 0);
+    stats.profile = activeCacheProfile;
+    return stats;
+}
+
+void MpvWidget::prefillFromProbe(const QString &url)
+{
+    // The file being replaced keeps its position for next time
+    storeProbe(state.timePos);
+    probeReady = false;
+    probePrefilled = false;
+
+    probeKey = fileIdentity(url);
+    probeInfo = ProbeInfo();
+
+    double start = 0;
+    if (probeCache->lookup(probeKey, &probeInfo)) {
+        probePrefilled = true;
+        state.duration = probeInfo.duration;
+        state.tracks = probeInfo.tracks;
+        state.chapters = probeInfo.chapters;
+
+        // Resume unless it was barely started or nearly finished
+        const double resume = probeInfo.resumePosition;
+        if (resume >= kResumeMinSeconds && resume < probeInfo.duration - kResumeTailSeconds)
+            start = resume;
+
+        state.timePos = start;
+        emit durationChanged(state.duration);
+        emit positionChanged(state.timePos);
+        scheduleControlsRefresh();
+    } else if (probedMedia.value(url).duration > 0) {
+        // Opened in bulk: at least the length is known before mpv reports it
+        state.duration = probedMedia.value(url).duration;
+        emit durationChanged(state.duration);
+        scheduleControlsRefresh();
+    }
+
+    // Applies to the file about to be opened; cleared again once it has loaded
+    const QByteArray startValue = start > 0 ? QByteArray::number(start, 'f', 3) : QByteArray("none");
+    mpv_set_property_string(mpv, "start", startValue.constData());
+}
+
+void MpvWidget::onFileLoaded()
+{
+    decodePlayedSeconds = 0;
+    decodeLastTimePos = -1;
+    decodeDropBase = 0;
+
+    mpv_set_property_string(mpv, "start", "none");
+    probePrefilled = false;
+
+    // Gapless advances bypass play(); look the new file up here
+    const QString key = fileIdentity(playlist.url(playlist.currentIndex()));
+    if (key != probeKey) {
+        probeKey = key;
+        probeInfo = ProbeInfo();
+        probeCache->lookup(probeKey, &probeInfo);
+    }
+
+    probeReady = !probeKey.isEmpty();
+    if (probeReady)
+        probeStoreTimer->start();
+}
+
+void MpvWidget::startKeyframeIndex(const QString &url)
+{
+    shuttle->setSource(url);
+
+    // Seeded with what earlier opens found; local files get the full walk
+    keyframes.clear();
+    keyframes.add(probeInfo.keyframes);
+
+    QString path;
+    fileIdentity(url, &path);
+    keyframeIndexer->index(path, ++keyframeGeneration);
+}
+
+void MpvWidget::storeProbe(double resumePosition)
+{
+    probeStoreTimer->stop();
+    if (!probeReady)
+        return;
+
+    probeInfo.resumePosition = resumePosition;
+    probeCache->store(probeKey, probeInfo);
 }
@@ -1,37 +1,142 @@
 #pragma once
 
-#include <QOpenGLWidget>
+#include <QWidget>
 #include <QString>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QLabel>
+#include <QThread>
+#include <future>
 #include <mpv/client.h>
-#include <mpv/render_gl.h>
 #include "controlbar.h"
+#include "framestats.h"
+#include "mpveventthread.h"
+#include "playerstate.h"
+#include "seekscheduler.h"
+#include "thumbnailer.h"
+#include "playlist.h"
+#include "statsoverlay.h"
+#include "videobackend.h"
+#include "cacheprofile.h"
+#include "probecache.h"
+#include "decodetuner.h"
+#include "keyframeindex.h"
+#include "shuttle.h"
+#include "framegrabber.h"
+#include "memorybudget.h"
+#include "mediaingest.h"
 
 
-class MpvWidget : public QOpenGLWidget
+class MpvWidget : public QWidget
 {
     Q_OBJECT
     QSize sizeHint() const override { return QSize(800, 600); }
-    bool isPaused = false;
 
 
 public:
-    explicit MpvWidget(QWidget *parent = nullptr);
+    explicit MpvWidget(QWidget *parent = nullptr, VideoBackend::Mode renderMode = VideoBackend::Composited);
     ~MpvWidget();
 
     void play(const QString &url);
+    void toggleStatsOverlay();
+
+    // Append to the playlist without interrupting playback; returns how many were new
+    int enqueue(const QStringList &urls);
+    // Files, directories (recursively), M3U/PLS playlists and URLs, listed in
+    // the background; the first entry found plays, the rest is queued behind it
+    void open(const QStringList &inputs);
+    // Duration and codecs of a queued local file, once probed in the background
+    ProbedMedia probedMediaInfo(const QString &path) const { return probedMedia.value(path); }
+    void seek(double seconds, bool relative = false);
+    void setPaused(bool paused);
+
+    // Saves the frame on screen at source resolution in the background;
+    // false when too many grabs are still in flight
+    bool captureFrame();
+    void captureBurst(int count, int intervalMs);
+    FrameGrabber *frameGrabber() const { return grabber; }
+
+    // Extra mpv options; applied once the core is adopted (runtime-settable options only)
+    void setMpvOption(const QString &name, const QString &value);
+    mpv_handle *handle() const { return mpv; }
+
+    // Stream cache settings per source type, applied when a file is opened
+    void setCacheProfiles(const CacheProfiles &profiles) { cacheProfiles = profiles; }
+
+    // Rebuffering for the current file
+    struct StreamStats
+    {
+        int stalls = 0;           // times playback paused to wait for the cache
+        qint64 rebufferMs = 0;    // total time spent waiting, including a stall in progress
+        QString profile;          // cache profile the file was opened with
+    };
+    StreamStats streamStats() const;
+
+    // Remember duration, tracks, chapters and position of local files here
+    void setProbeCacheFile(const QString &path) { probeCache->setFile(path); }
+
+    // Pick decoder threading per file (default on); applies from the next file.
+    // Turned off, the next file decodes with mpv's defaults again.
+    void setDecodeTuning(bool enabled) { decodeTuning = enabled; }
+    const DecodeConfig &decoderConfig() const { return decodeConfig; }
+
+    // Drop the video output and its render context for every file, e.g. for
+    // music playlists; turning it off brings video back without a restart.
+    // Files without video get the same treatment on their own.
+    void setAudioOnly(bool enabled);
+    bool audioOnlyEnabled() const { return audioOnlyForced; }
+    // No video output for the current file, whichever the reason
+    bool isAudioOnly() const { return audioOnly; }
+
+    // One budget for the demuxer cache, thumbnails, metadata and frame grabs
+    // (bytes, 0 for no limits); shrunk step by step under memory pressure
+    void setMemoryBudget(qint64 bytes);
+    const MemoryBudget &memoryBudget() const { return budget; }
+    MemoryUsage memoryUsage() const;
+
+    // Keep the control bar on screen instead of auto-hiding it
+    void setControlsPinned(bool pinned) { controls->setPinned(pinned); }
+
+    // Move to the next playlist entry when a file ends (default on)
+    void setAutoAdvance(bool enabled) { autoAdvance = enabled; }
+
+    // Restore the playlist from this file and keep it saved there
+    void setPlaylistFile(const QString &path);
+    const Playlist &playlistEntries() const { return playlist; }
+
+    // Frame timing collection, normally driven by the stats overlay
+    void setFrameStatsEnabled(bool enabled);
+    const FrameStats &frameTimings() const { return frameStats; }
+
+    const PlayerState &playerState() const { return state; }
+
+    // Active while playing on screen. Paused stops position updates; Hidden
+    // (minimized or not shown) also stops redraws and UI timers.
+    enum class PowerState { Active, Paused, Hidden };
+    PowerState powerState() const { return power; }
+
+    // Work done since the current idle (Paused/Hidden) period began
+    struct IdleStats
+    {
+        qint64 idleMs = 0;
+        quint64 guiWakeups = 0;   // event loop wakeups on the GUI thread
+        quint64 mpvEvents = 0;    // events delivered by mpv
+    };
+    IdleStats idleStats() const;
+    VideoBackend::Mode renderMode() const { return video->mode(); }
 
 protected:
-    void initializeGL() override;
-    void paintGL() override;
-    void resizeGL(int w, int h) override;
     void resizeEvent(QResizeEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
     bool eventFilter(QObject *obj, QEvent *event) override;
     void mouseMoveEvent(QMouseEvent *event) override;
     void enterEvent(QEnterEvent *event) override;
     void leaveEvent(QEvent *event) override;
     void mouseDoubleClickEvent(QMouseEvent *event) override;
     void keyPressEvent(QKeyEvent *event) override;
+    void keyReleaseEvent(QKeyEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
     void dragEnterEvent(QDragEnterEvent *event) override;
     void dragMoveEvent(QDragMoveEvent *event) override;
     void dropEvent(QDropEvent *event) override;
@@ -44,24 +149,186 @@ public slots:
 
 private slots:
     void setupControlConnections();
+    void adoptCore();
+    void onVideoAttached();
+    void onVideoFailed();
+    void onFramePresented();
 
 signals:
+    void initialized();
     void durationChanged(double seconds);
     void positionChanged(double seconds);
+    void playbackEnded(bool error);
+    // Something in playerState() or the playlist changed
+    void stateChanged();
 
 private:
+    // One row per observed property; adding a property is a row and a handler
+    struct ObservedProperty
+    {
+        MpvObserveId id;
+        const char *name;
+        mpv_format format;
+        // True when PlayerState changed
+        bool (MpvWidget::*apply)(const MpvUpdate &update);
+    };
+    // Defined constexpr in the source, where its order is checked at compile time
+    static const ObservedProperty observedProperties[ObserveLast];
+    static constexpr bool observedIdsInOrder();
+
+    void setupVideo(VideoBackend::Mode mode);
     void repositionControls();
     bool isControlsHovered() const;
-    QStringList playlist;
-    int currentIndex = -1;
+    void updateStatsOverlay();
+    void applyProperty(const MpvUpdate &update);
+    bool onTimePos(const MpvUpdate &update);
+    bool onDuration(const MpvUpdate &update);
+    bool onPause(const MpvUpdate &update);
+    bool onPausedForCache(const MpvUpdate &update);
+    bool onCacheDuration(const MpvUpdate &update);
+    bool onTrackList(const MpvUpdate &update);
+    bool onContainerFps(const MpvUpdate &update);
+    bool onCacheState(const MpvUpdate &update);
+    bool onChapterList(const MpvUpdate &update);
+    bool onDecoderDrops(const MpvUpdate &update);
+    void onPreloaded();
+    void tuneDecoder(const QVariant &trackList);
+    void selectVideoOutput(const QVariant &trackList);
+    void enterAudioOnly();
+    void leaveAudioOnly();
+    void scheduleControlsRefresh();
+    void refreshControls();
+    void showSeekPreview(double fraction, int x);
+    void updateSeekPreview(double seconds, const QImage &image);
+    void schedulePlaylistSave();
+    void queuePrefetch();
+    void onStartFile();
+    int loadFile(const QString &url, const char *flags, const QByteArray &options, quint64 replyId);
+    QByteArray cacheOptions(const CacheProfile &profile) const;
+    void setActiveCacheProfile(const CacheProfile &profile);
+    void applyDemuxerLimits();
+    void checkMemory();
+    void applyMemoryLimits();
+    void trimProbedMedia();
+    void prefillFromProbe(const QString &url);
+    void onFileLoaded();
+    void storeProbe(double resumePosition);
+    void startKeyframeIndex(const QString &url);
+    QString captureName() const;
+    void updatePowerState();
+    void setTimePosObserved(bool observed);
+    void trackScreen(QScreen *screen);
+    void updateDisplayFps();
+
+    Playlist playlist;
+    QString playlistFile;
+    QTimer *playlistSaveTimer;
+
+    // Gapless: the next entry sits in mpv's own playlist behind the current one
+    int prefetchedIndex = -1;
+    bool replacingFile = false;
+    qint64 transitionStartNs = -1;
+    bool transitionArmed = false;
+    FrameTimeRing transitionLatency;
     QString pendingPlayUrl;
+    QList<QPair<QByteArray, QByteArray>> extraOptions;
 
 
+    std::future<mpv_handle *> coreFuture;
     mpv_handle *mpv = nullptr;
-    mpv_render_context *mpv_gl = nullptr;
+    VideoBackend *video;
+    bool traceFirstFrame = false;
+    bool initializedSent = false;
+
+    // Audio only: render context freed, the surface swapped for a still screen
+    bool audioOnlyForced = false;
+    bool audioOnly = false;
+    QString audioOnlyTitle;
+    MpvEventThread *eventThread = nullptr;
+    SeekScheduler *seekScheduler;
+
+    // Seek-bar hover previews from a secondary mpv instance
+    Thumbnailer *thumbnailer;
+    QLabel *seekPreview;
+    double previewSeconds = -1;
+    int previewX = 0;
     ControlBar *controls;
     QTimer *cursorHideTimer;
+    QElapsedTimer lastMouseActivity;
     bool isSeekingManually = false;
+    bool autoAdvance = true;
+
+    CacheProfiles cacheProfiles;
+    QString activeCacheProfile;
+    qint64 profileForwardBytes = 0;
+    qint64 profileBackBytes = 0;
+    int cacheStalls = 0;
+    qint64 rebufferMs = 0;
+    QElapsedTimer stallClock;
+
+    // What is known about the current file from earlier opens. Prefilled
+    // until mpv reports on the file; Ready once it has loaded.
+    static constexpr double kResumeMinSeconds = 5;
+    static constexpr double kResumeTailSeconds = 10;
+    ProbeCache *probeCache;
+    QTimer *probeStoreTimer;
+    QString probeKey;
+    ProbeInfo probeInfo;
+    bool probePrefilled = false;
+    bool probeReady = false;
+
+    // Software decoder settings chosen for the current file
+    DecodeTuner decodeTuner{QThread::idealThreadCount()};
+    bool decodeTuning = true;
+    DecodeInput decodeInput;
+    DecodeConfig decodeConfig;
+    bool decodeConfigApplied = false;   // tuned options set on mpv, not its defaults
+    // Drops since the decoder was last created, over unpaused playback
+    qint64 decodeDropBase = 0;
+    double decodePlayedSeconds = 0;
+    double decodeLastTimePos = -1;
+
+    // J/K/L review controls over a keyframe index built in the background
+    KeyframeIndexer *keyframeIndexer;
+    KeyframeIndex keyframes;
+    quint64 keyframeGeneration = 0;
+    Shuttle *shuttle;
+    bool shuttleHeld = false;   // K down: J and L step frames
+
+    FrameGrabber *grabber;
+
+    // Bulk opens: entries stream in while directories are still being listed
+    MediaIngest *ingest;
+    MediaProber *prober;
+    QHash<QString, ProbedMedia> probedMedia;
+    QQueue<QString> probedOrder;    // oldest result first
+    int probedMediaCapacity = -1;
+    quint64 playFirstRequest = 0;
+
+    // Checked every few seconds while a budget is set
+    MemoryBudget budget;
+    QTimer *memoryTimer;
+
+    // Filled from observed properties; controls redraw from it at a capped rate
+    PlayerState state;
+    QTimer *controlsRefreshTimer;
+    bool positionMoved = false;   // stateChanged() owed for time-pos, sent at the refresh rate
+
+    PowerState power = PowerState::Active;
+    bool timePosObserved = true;
+    bool windowFiltered = false;
+
+    // Refresh rate handed to mpv for display-synced playback
+    double displayFps = 0;
+    QMetaObject::Connection refreshRateConnection;
+    QElapsedTimer idleClock;
+    quint64 idleGuiWakeups = 0;
+    quint64 idleMpvEventsStart = 0;
 
-    friend void on_mpv_events(void *ctx);
+    // Frame timing is only collected while the stats overlay is shown
+    StatsOverlay *statsOverlay;
+    QTimer *statsTimer;
+    FrameStats frameStats;
+    QElapsedTimer frameClock;
+    bool frameStatsEnabled = false;
 };
@@ -0,0 +1,63 @@
+#include "playerstate.h"
+#include <QVariantMap>
+
+bool PlayerState::hasVideo() const
+{
+    for (const TrackInfo &track : tracks) {
+        if (track.type == QLatin1String("video") && !track.albumart)
+            return true;
+    }
+    return false;
+}
+
+QList<TrackInfo> PlayerState::parseTrackList(const QVariant &node)
+{
+    QList<TrackInfo> result;
+    const QVariantList list = node.toList();
+    result.reserve(list.size());
+
+    for (const QVariant &entry : list) {
+        const QVariantMap map = entry.toMap();
+        TrackInfo track;
+        track.id = map.value("id").toLongLong();
+        track.type = map.value("type").toString();
+        track.title = map.value("title").toString();
+        track.lang = map.value("lang").toString();
+        track.codec = map.value("codec").toString();
+        track.selected = map.value("selected").toBool();
+        track.albumart = map.value("albumart").toBool();
+        track.width = map.value("demux-w").toInt();
+        track.height = map.value("demux-h").toInt();
+        result.append(track);
+    }
+    return result;
+}
+
+QList<ChapterInfo> PlayerState::parseChapterList(const QVariant &node)
+{
+    QList<ChapterInfo> result;
+    const QVariantList list = node.toList();
+    result.reserve(list.size());
+
+    for (const QVariant &entry : list) {
+        const QVariantMap map = entry.toMap();
+        result.append({map.value("time").toDouble(), map.value("title").toString()});
+    }
+    return result;
+}
+
+void PlayerState::setCacheState(const QVariant &node)
+{
+    const QVariantMap map = node.toMap();
+    cacheForwardBytes = map.value("fw-bytes").toLongLong();
+    cacheTotalBytes = map.value("total-bytes").toLongLong();
+    cacheInputRate = map.value("raw-input-rate").toDouble();
+
+    cachedRanges.clear();
+    const QVariantList ranges = map.value("seekable-ranges").toList();
+    cachedRanges.reserve(ranges.size());
+    for (const QVariant &entry : ranges) {
+        const QVariantMap range = entry.toMap();
+        cachedRanges.append({range.value("start").toDouble(), range.value("end").toDouble()});
+    }
+}
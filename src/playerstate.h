@@ -0,0 +1,54 @@
+#pragma once
+#include <QList>
+#include <QString>
+#include <QVariant>
+
+struct TrackInfo
+{
+    qint64 id = 0;
+    QString type;      // "video", "audio" or "sub"
+    QString title;
+    QString lang;
+    QString codec;
+    bool selected = false;
+    bool albumart = false;
+    int width = 0;
+    int height = 0;
+};
+
+struct ChapterInfo
+{
+    double time = 0;
+    QString title;
+};
+
+struct CacheRange
+{
+    double start = 0;
+    double end = 0;
+};
+
+// Snapshot of the player, filled only from observed mpv properties so UI code
+// never has to ask mpv synchronously.
+struct PlayerState
+{
+    double duration = 0;
+    double timePos = 0;
+    bool paused = false;
+    bool pausedForCache = false;
+    double cacheDuration = 0;   // seconds buffered ahead (demuxer-cache-duration)
+    // From demuxer-cache-state
+    QList<CacheRange> cachedRanges;
+    qint64 cacheForwardBytes = 0;
+    qint64 cacheTotalBytes = 0;
+    double cacheInputRate = 0;  // bytes per second read from the source
+    double containerFps = 0;
+    QList<TrackInfo> tracks;
+    QList<ChapterInfo> chapters;
+
+    bool hasVideo() const;
+    void setCacheState(const QVariant &node);
+
+    static QList<TrackInfo> parseTrackList(const QVariant &node);
+    static QList<ChapterInfo> parseChapterList(const QVariant &node);
+};
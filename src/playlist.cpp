@@ -0,0 +1,215 @@
+#include "playlist.h"
+#include <QDebug>
+#include <QFile>
+#include <QSaveFile>
+#include <cstring>
+#include <type_traits>
+
+// File layout (host byte order): Header, Entry[count], blob[blobSize]
+struct PlaylistFileHeader
+{
+    char magic[4];
+    quint32 version;
+    quint32 count;
+    quint32 nextId;
+    qint32 current;
+    quint32 blobSize;
+    quint64 reserved;
+};
+
+static constexpr char kMagic[4] = {'O', 'I', 'P', 'L'};
+static constexpr quint32 kVersion = 1;
+
+static_assert(std::is_trivially_copyable<Playlist::Entry>::value, "Entry is written verbatim");
+static_assert(sizeof(Playlist::Entry) == 24, "Entry layout is part of the file format");
+static_assert(sizeof(PlaylistFileHeader) == 32, "Header layout is part of the file format");
+
+quint64 Playlist::hashUrl(const QByteArray &utf8)
+{
+    quint64 h = 14695981039346656037ULL;
+    for (char c : utf8) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+QString Playlist::url(int index) const
+{
+    if (index < 0 || index >= size())
+        return QString();
+
+    const Entry &e = entries[index];
+    return QString::fromUtf8(blob.constData() + e.offset, e.length);
+}
+
+int Playlist::find(const QByteArray &utf8, quint64 hash) const
+{
+    for (auto it = byHash.constFind(hash); it != byHash.cend() && it.key() == hash; ++it) {
+        const Entry &e = entries[it.value()];
+        if (e.length == static_cast<quint32>(utf8.size())
+            && std::memcmp(blob.constData() + e.offset, utf8.constData(), e.length) == 0) {
+            return it.value();
+        }
+    }
+    return -1;
+}
+
+int Playlist::indexOf(const QString &url) const
+{
+    const QByteArray utf8 = url.toUtf8();
+    return find(utf8, hashUrl(utf8));
+}
+
+int Playlist::append(const QString &url)
+{
+    const QByteArray utf8 = url.toUtf8();
+    const quint64 hash = hashUrl(utf8);
+
+    const int existing = find(utf8, hash);
+    if (existing >= 0)
+        return existing;
+
+    Entry e;
+    e.id = nextId++;
+    e.offset = static_cast<quint32>(blob.size());
+    e.length = static_cast<quint32>(utf8.size());
+    e.flags = 0;
+    e.hash = hash;
+
+    const int index = size();
+    blob.append(utf8);
+    entries.push_back(e);
+    byHash.insert(hash, index);
+    byId.insert(e.id, index);
+    return index;
+}
+
+int Playlist::append(const QStringList &urls)
+{
+    const int before = size();
+    entries.reserve(entries.size() + urls.size());
+    for (const QString &url : urls)
+        append(url);
+    return size() - before;
+}
+
+void Playlist::clear()
+{
+    entries.clear();
+    blob.clear();
+    byHash.clear();
+    byId.clear();
+    current = -1;
+}
+
+void Playlist::setCurrentIndex(int index)
+{
+    current = (index >= 0 && index < size()) ? index : -1;
+}
+
+int Playlist::nextIndex() const
+{
+    if (isEmpty())
+        return -1;
+    return (current + 1) % size();
+}
+
+int Playlist::previousIndex() const
+{
+    if (isEmpty())
+        return -1;
+    return current <= 0 ? size() - 1 : current - 1;
+}
+
+bool Playlist::save(const QString &path) const
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot write playlist" << path << ":" << file.errorString();
+        return false;
+    }
+
+    PlaylistFileHeader header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.count = static_cast<quint32>(entries.size());
+    header.nextId = nextId;
+    header.current = current;
+    header.blobSize = static_cast<quint32>(blob.size());
+    header.reserved = 0;
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(entries.data()),
+               static_cast<qint64>(entries.size() * sizeof(Entry)));
+    file.write(blob);
+    return file.commit();
+}
+
+bool Playlist::load(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    const qint64 fileSize = file.size();
+    if (fileSize < static_cast<qint64>(sizeof(PlaylistFileHeader)))
+        return false;
+
+    const uchar *data = file.map(0, fileSize);
+    if (!data)
+        return false;
+
+    PlaylistFileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    const qint64 entriesBytes = static_cast<qint64>(header.count) * sizeof(Entry);
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion
+        || static_cast<qint64>(sizeof(header)) + entriesBytes + header.blobSize != fileSize) {
+        qWarning() << "Ignoring unreadable playlist" << path;
+        return false;
+    }
+
+    clear();
+    entries.resize(header.count);
+    std::memcpy(entries.data(), data + sizeof(header), static_cast<size_t>(entriesBytes));
+    blob = QByteArray(reinterpret_cast<const char *>(data + sizeof(header) + entriesBytes),
+                      static_cast<qsizetype>(header.blobSize));
+
+    // Nothing on disk is trusted: a stale or damaged file must not leave
+    // wrong hashes, repeated URLs or colliding ids in the indexes
+    byHash.reserve(header.count);
+    byId.reserve(header.count);
+    for (int i = 0; i < size(); ++i) {
+        Entry &e = entries[i];
+        if (static_cast<qint64>(e.offset) + e.length > blob.size()
+            || e.id == 0 || e.id >= header.nextId || byId.contains(e.id)) {
+            qWarning() << "Corrupt playlist entry in" << path;
+            clear();
+            return false;
+        }
+
+        const QByteArray utf8 = QByteArray::fromRawData(blob.constData() + e.offset, static_cast<qsizetype>(e.length));
+        e.hash = hashUrl(utf8);
+        if (find(utf8, e.hash) >= 0) {
+            qWarning() << "Duplicate playlist entry in" << path;
+            clear();
+            return false;
+        }
+        byHash.insert(e.hash, i);
+        byId.insert(e.id, i);
+    }
+
+    nextId = header.nextId;
+    setCurrentIndex(header.current);
+    return true;
+}
+
+qint64 Playlist::memoryUsage() const
+{
+    // Hash nodes are estimated; entries and blob are exact
+    return static_cast<qint64>(entries.capacity() * sizeof(Entry))
+         + blob.capacity()
+         + static_cast<qint64>(byHash.size()) * 32
+         + static_cast<qint64>(byId.size()) * 24;
+}
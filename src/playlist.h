@@ -0,0 +1,59 @@
+#pragma once
+#include <QByteArray>
+#include <QHash>
+#include <QMultiHash>
+#include <QString>
+#include <QStringList>
+#include <vector>
+
+// Playlist storage for very large lists. URLs live back to back in one UTF-8
+// blob, entries are fixed-size records pointing into it, and two hashes give
+// O(1) duplicate detection and id lookup. The on-disk format is the same
+// header + records + blob, so restoring is a map and two memcpys.
+class Playlist
+{
+public:
+    struct Entry
+    {
+        quint32 id;
+        quint32 offset;   // into the URL blob
+        quint32 length;
+        quint32 flags;    // reserved
+        quint64 hash;     // FNV-1a of the UTF-8 URL
+    };
+
+    int size() const { return static_cast<int>(entries.size()); }
+    bool isEmpty() const { return entries.empty(); }
+
+    QString url(int index) const;
+    quint32 id(int index) const { return entries[index].id; }
+    int indexOf(const QString &url) const;
+    int indexOfId(quint32 id) const { return byId.value(id, -1); }
+
+    // Appends unless the URL is already present; returns its index either way
+    int append(const QString &url);
+    // Bulk append; returns how many new entries were added
+    int append(const QStringList &urls);
+    void clear();
+
+    int currentIndex() const { return current; }
+    void setCurrentIndex(int index);
+    int nextIndex() const;
+    int previousIndex() const;
+
+    bool save(const QString &path) const;
+    bool load(const QString &path);
+
+    qint64 memoryUsage() const;
+
+private:
+    static quint64 hashUrl(const QByteArray &utf8);
+    int find(const QByteArray &utf8, quint64 hash) const;
+
+    std::vector<Entry> entries;
+    QByteArray blob;
+    QMultiHash<quint64, int> byHash;
+    QHash<quint32, int> byId;
+    quint32 nextId = 1;
+    int current = -1;
+};
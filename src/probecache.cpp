@@ -0,0 +1,244 @@
+#include "probecache.h"
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <algorithm>
+
+static constexpr quint32 kMagic = 0x4f495043;   // "OIPC"
+static constexpr quint32 kVersion = 1;
+static constexpr int kMaxKeyframes = 1024;
+static constexpr double kKeyframeMergeSeconds = 0.5;
+
+void ProbeInfo::addKeyframe(double seconds)
+{
+    auto it = std::lower_bound(keyframes.begin(), keyframes.end(), seconds);
+
+    // Sparse index: neighbours closer than this add nothing for seeking
+    if (it != keyframes.end() && *it - seconds < kKeyframeMergeSeconds)
+        return;
+    if (it != keyframes.begin() && seconds - *(it - 1) < kKeyframeMergeSeconds)
+        return;
+    if (keyframes.size() >= kMaxKeyframes)
+        return;
+
+    keyframes.insert(it, seconds);
+}
+
+static QDataStream &operator<<(QDataStream &out, const TrackInfo &t)
+{
+    return out << t.id << t.type << t.title << t.lang << t.codec
+               << t.selected << t.albumart << qint32(t.width) << qint32(t.height);
+}
+
+static QDataStream &operator>>(QDataStream &in, TrackInfo &t)
+{
+    qint32 width = 0, height = 0;
+    in >> t.id >> t.type >> t.title >> t.lang >> t.codec >> t.selected >> t.albumart >> width >> height;
+    t.width = width;
+    t.height = height;
+    return in;
+}
+
+static QDataStream &operator<<(QDataStream &out, const ChapterInfo &c)
+{
+    return out << c.time << c.title;
+}
+
+static QDataStream &operator>>(QDataStream &in, ChapterInfo &c)
+{
+    return in >> c.time >> c.title;
+}
+
+ProbeCache::ProbeCache(QObject *parent) : QObject(parent)
+{
+    // Playback produces bursts of updates; write once they settle
+    saveTimer = new QTimer(this);
+    saveTimer->setSingleShot(true);
+    saveTimer->setInterval(2000);
+    connect(saveTimer, &QTimer::timeout, this, &ProbeCache::save);
+}
+
+ProbeCache::~ProbeCache()
+{
+    flush();
+}
+
+void ProbeCache::setFile(const QString &file)
+{
+    path = file;
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    loadFuture = std::async(std::launch::async, &ProbeCache::readFile, path, capacity);
+}
+
+void ProbeCache::setCapacity(int count)
+{
+    capacity = qMax(1, count);
+    evict();
+}
+
+qint64 ProbeCache::memoryUsage() const
+{
+    // Hash node and string overheads are estimated; the lists are close
+    qint64 bytes = 0;
+    for (auto it = entries.cbegin(); it != entries.cend(); ++it) {
+        const ProbeInfo &info = it->info;
+        bytes += 64 + it.key().size() * 2
+               + info.tracks.size() * qint64(sizeof(TrackInfo) + 64)
+               + info.chapters.size() * qint64(sizeof(ChapterInfo) + 32)
+               + info.keyframes.size() * qint64(sizeof(double));
+    }
+    return bytes;
+}
+
+bool ProbeCache::mergeLoaded(bool wait)
+{
+    if (!loadFuture.valid())
+        return true;
+    if (!wait && loadFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return false;
+
+    EntryMap loaded = loadFuture.get();
+    quint64 newest = 0;
+    for (const Entry &entry : std::as_const(loaded))
+        newest = qMax(newest, entry.lastUsed);
+
+    // Entries stored before the load finished win over the file's and are
+    // the most recently used
+    for (auto it = entries.cbegin(); it != entries.cend(); ++it) {
+        Entry &entry = loaded[it.key()];
+        entry = it.value();
+        entry.lastUsed += newest;
+    }
+    entries = std::move(loaded);
+
+    for (const Entry &entry : std::as_const(entries))
+        useCounter = qMax(useCounter, entry.lastUsed);
+    evict();
+    return true;
+}
+
+bool ProbeCache::lookup(const QString &key, ProbeInfo *info)
+{
+    if (key.isEmpty())
+        return false;
+
+    // The first open must not wait for the disk; it is probed as usual
+    if (!mergeLoaded(false))
+        return false;
+    auto it = entries.find(key);
+    if (it == entries.end())
+        return false;
+
+    it->lastUsed = ++useCounter;
+    *info = it->info;
+    return true;
+}
+
+void ProbeCache::store(const QString &key, const ProbeInfo &info)
+{
+    if (key.isEmpty())
+        return;
+
+    // Merged with the file's entries once those are in
+    mergeLoaded(false);
+    Entry &entry = entries[key];
+    entry.info = info;
+    entry.lastUsed = ++useCounter;
+    evict();
+
+    if (!path.isEmpty())
+        saveTimer->start();
+}
+
+void ProbeCache::evict()
+{
+    while (entries.size() > capacity) {
+        auto oldest = entries.begin();
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            if (it->lastUsed < oldest->lastUsed)
+                oldest = it;
+        }
+        entries.erase(oldest);
+    }
+}
+
+void ProbeCache::save()
+{
+    // Writing before the load is in would drop the file's entries, and one
+    // write at a time; try again once the running one is done
+    if (!mergeLoaded(false)
+        || (saveFuture.valid() && saveFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready)) {
+        saveTimer->start();
+        return;
+    }
+
+    if (saveFuture.valid())
+        saveFuture.get();
+    saveFuture = std::async(std::launch::async, &ProbeCache::writeFile, path, entries);
+}
+
+void ProbeCache::flush()
+{
+    if (saveTimer->isActive()) {
+        mergeLoaded(true);
+        saveTimer->stop();
+        if (saveFuture.valid())
+            saveFuture.get();
+        writeFile(path, entries);
+    }
+    if (saveFuture.valid())
+        saveFuture.get();
+}
+
+ProbeCache::EntryMap ProbeCache::readFile(const QString &path, int capacity)
+{
+    EntryMap entries;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return entries;
+
+    QDataStream in(&file);
+    quint32 magic = 0, version = 0, count = 0;
+    in >> magic >> version >> count;
+    if (magic != kMagic || version != kVersion) {
+        qWarning() << "Ignoring unreadable probe cache" << path;
+        return entries;
+    }
+
+    // The count comes from disk; a damaged file must not size the allocation
+    entries.reserve(qMin(count, quint32(capacity)));
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString key;
+        Entry entry;
+        in >> key >> entry.lastUsed >> entry.info.duration >> entry.info.resumePosition
+           >> entry.info.tracks >> entry.info.chapters >> entry.info.keyframes;
+        entries.insert(key, entry);
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        qWarning() << "Corrupt probe cache" << path;
+        entries.clear();
+    }
+    return entries;
+}
+
+bool ProbeCache::writeFile(const QString &path, const EntryMap &entries)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot write probe cache" << path << ":" << file.errorString();
+        return false;
+    }
+
+    QDataStream out(&file);
+    out << kMagic << kVersion << quint32(entries.size());
+    for (auto it = entries.cbegin(); it != entries.cend(); ++it) {
+        const ProbeInfo &info = it->info;
+        out << it.key() << it->lastUsed << info.duration << info.resumePosition
+            << info.tracks << info.chapters << info.keyframes;
+    }
+    return file.commit();
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <future>
+#include "playerstate.h"
+
+// What a previous open found out about a file
+struct ProbeInfo
+{
+    double duration = 0;
+    QList<TrackInfo> tracks;
+    QList<ChapterInfo> chapters;
+    QList<double> keyframes;      // sparse and sorted, from previews and the keyframe index
+    double resumePosition = 0;
+
+    void addKeyframe(double seconds);
+};
+
+// Metadata for recently played local files, keyed by file identity (path,
+// size, mtime) so a changed file is probed afresh. Bounded to a number of
+// entries with least-recently-used eviction. The file is read and written on
+// a worker thread; until the initial load is in, lookups miss rather than wait.
+class ProbeCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ProbeCache(QObject *parent = nullptr);
+    ~ProbeCache() override;
+
+    // Starts loading in the background; changes are saved there too
+    void setFile(const QString &path);
+    void setCapacity(int entries);
+    static constexpr int kDefaultCapacity = 500;
+    int size() const { return entries.size(); }
+    // Estimated heap use of the entries held
+    qint64 memoryUsage() const;
+
+    bool lookup(const QString &key, ProbeInfo *info);
+    void store(const QString &key, const ProbeInfo &info);
+
+    // Write pending changes now and wait for it
+    void flush();
+
+private:
+    struct Entry
+    {
+        ProbeInfo info;
+        quint64 lastUsed = 0;
+    };
+    using EntryMap = QHash<QString, Entry>;
+
+    // Takes in the initial load once done; false while it is still running
+    bool mergeLoaded(bool wait);
+    void evict();
+    void save();
+
+    static EntryMap readFile(const QString &path, int capacity);
+    static bool writeFile(const QString &path, const EntryMap &entries);
+
+    QString path;
+    EntryMap entries;
+    quint64 useCounter = 0;
+    int capacity = kDefaultCapacity;
+
+    std::future<EntryMap> loadFuture;
+    std::future<bool> saveFuture;
+    QTimer *saveTimer;
+};
@@ -0,0 +1,96 @@
+#include "seekscheduler.h"
+#include "mpveventthread.h"
+#include <QByteArray>
+#include <QDebug>
+
+// A seek that never reports a restart (no file, seek past the end) must not
+// block later ones forever
+static constexpr int kSeekWatchdogMs = 1500;
+
+SeekScheduler::SeekScheduler(QObject *parent)
+: QObject(parent)
+{
+    clock.start();
+
+    watchdog = new QTimer(this);
+    watchdog->setSingleShot(true);
+    watchdog->setInterval(kSeekWatchdogMs);
+    connect(watchdog, &QTimer::timeout, this, &SeekScheduler::finishInFlight);
+}
+
+void SeekScheduler::seek(double target, bool precise)
+{
+    if (!mpv)
+        return;
+
+    if (inFlight) {
+        // A precise request must not be downgraded by a later scrub event
+        pendingPrecise = (hasPending && pendingPrecise) || precise;
+        hasPending = true;
+        pendingTarget = target;
+        return;
+    }
+
+    dispatch(target, precise);
+}
+
+void SeekScheduler::dispatch(double target, bool precise)
+{
+    const QByteArray pos = QByteArray::number(qMax(0.0, target), 'f', 3);
+    const char *args[] = {"seek", pos.constData(), precise ? "absolute+exact" : "absolute+keyframes", nullptr};
+
+    int r = mpv_command_async(mpv, AsyncSeek, args);
+    if (r < 0) {
+        qWarning() << "Failed to queue seek:" << mpv_error_string(r);
+        return;
+    }
+
+    inFlight = true;
+    // A chained seek supersedes the frame the previous one was waiting for
+    awaitingFrame = false;
+    issuedNs = clock.nsecsElapsed();
+    watchdog->start();
+}
+
+void SeekScheduler::commandReply(int error)
+{
+    // The reply only means the seek was queued; completion is the restart
+    if (error < 0)
+        finishInFlight();
+}
+
+void SeekScheduler::playbackRestarted()
+{
+    if (!inFlight)
+        return;
+
+    awaitingFrame = true;
+    finishInFlight();
+}
+
+void SeekScheduler::fileEnded()
+{
+    hasPending = false;
+    awaitingFrame = false;
+    inFlight = false;
+    watchdog->stop();
+}
+
+void SeekScheduler::finishInFlight()
+{
+    inFlight = false;
+    watchdog->stop();
+
+    if (hasPending) {
+        hasPending = false;
+        const bool precise = pendingPrecise;
+        pendingPrecise = false;
+        dispatch(pendingTarget, precise);
+    }
+}
+
+void SeekScheduler::recordFirstFrame()
+{
+    awaitingFrame = false;
+    latencyRing.add((clock.nsecsElapsed() - issuedNs) / 1000);
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <QObject>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <mpv/client.h>
+#include "framestats.h"
+
+// Issues seeks with mpv_command_async, keeping at most one in flight. While a
+// seek runs, newer requests replace each other and only the latest target is
+// sent once mpv reports the playback restart. A pending seek stays precise
+// once any request merged into it asked for that.
+class SeekScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SeekScheduler(QObject *parent = nullptr);
+
+    void setHandle(mpv_handle *handle) { mpv = handle; }
+
+    // Fast keyframe seek while scrubbing, exact seek for the final position
+    void seek(double target, bool precise);
+
+    // Fed from MpvWidget's event processing and paint path
+    void commandReply(int error);
+    void playbackRestarted();
+    void fileEnded();
+    void framePresented()
+    {
+        if (awaitingFrame)
+            recordFirstFrame();
+    }
+
+    bool isBusy() const { return inFlight || hasPending; }
+
+    // Time from sending a seek to the first frame shown after it (us). Seeks
+    // replaced by a chained one before showing a frame are not sampled, so a
+    // drag records only the seek that settles it.
+    const FrameTimeRing &latency() const { return latencyRing; }
+
+private:
+    void dispatch(double target, bool precise);
+    void finishInFlight();
+    void recordFirstFrame();
+
+    mpv_handle *mpv = nullptr;
+    QTimer *watchdog;
+    QElapsedTimer clock;
+
+    bool inFlight = false;
+    bool hasPending = false;
+    double pendingTarget = 0;
+    bool pendingPrecise = false;
+
+    qint64 issuedNs = 0;
+    bool awaitingFrame = false;
+    FrameTimeRing latencyRing;
+};
@@ -0,0 +1,233 @@
+#include "shuttle.h"
+#include "mpveventthread.h"
+#include "mpvproperty.h"
+#include <QDebug>
+#include <iterator>
+
+// Shuttle rates, each press of J or L moves one further
+static constexpr int kRates[] = {1, 2, 4, 8, 16, 32};
+// Faster than this the decoder cannot keep up with every frame; hop instead
+static constexpr int kMaxPlayedRate = 2;
+// Keyframe hops per second while scrubbing
+static constexpr int kScrubIntervalMs = 66;
+// Keyframe jumps without an index (yet)
+static constexpr double kJumpSeconds = 5;
+static constexpr double kMinJumpSeconds = 0.01;
+// Decoded frames mpv may hold for stepping backwards through one GOP
+static constexpr qint64 kReverseCacheBytes = 256LL * 1024 * 1024;
+
+static int fasterRate(int rate)
+{
+    for (int r : kRates) {
+        if (r > rate)
+            return r;
+    }
+    return kRates[std::size(kRates) - 1];
+}
+
+Shuttle::Shuttle(SeekScheduler *seeks, const PlayerState *state, const KeyframeIndex *keyframes, QObject *parent)
+: QObject(parent)
+, seeks(seeks)
+, state(state)
+, keyframes(keyframes)
+{
+    clock.start();
+
+    scrubTimer = new QTimer(this);
+    scrubTimer->setInterval(kScrubIntervalMs);
+    connect(scrubTimer, &QTimer::timeout, this, &Shuttle::scrubTick);
+}
+
+void Shuttle::setHandle(mpv_handle *handle)
+{
+    mpv = handle;
+
+    // mpv's backward decoding keeps a GOP of decoded frames and hands them
+    // out in reverse; this bounds it
+    mpvSetOption(mpv, "video-reversal-buffer", QByteArray::number(kReverseCacheBytes));
+}
+
+void Shuttle::forward()
+{
+    setRate(currentRate > 0 ? fasterRate(currentRate) : kRates[0]);
+}
+
+void Shuttle::reverse()
+{
+    setRate(currentRate < 0 ? -fasterRate(-currentRate) : -kRates[0]);
+}
+
+void Shuttle::stop()
+{
+    setRate(0);
+}
+
+void Shuttle::setRate(int rate)
+{
+    if (!mpv)
+        return;
+
+    const bool wasScrubbing = scrubTimer->isActive();
+    currentRate = rate;
+    scrubTimer->stop();
+    setBackward(false);
+
+    if (rate > 0 && rate <= kMaxPlayedRate) {
+        mpvSetAsync(mpv, "speed", static_cast<double>(rate));
+        mpvSetAsync(mpv, "pause", false);
+    } else {
+        mpvSetAsync(mpv, "pause", true);
+        mpvSetAsync(mpv, "speed", 1.0);
+        if (rate != 0) {
+            // A change of rate mid-scrub carries on from where it got to
+            if (!wasScrubbing) {
+                scrubPos = state->timePos;
+                lastTarget = -1;
+            }
+            scrubClock.start();
+            scrubTimer->start();
+        }
+    }
+    emit rateChanged(rate);
+}
+
+void Shuttle::scrubTick()
+{
+    const double elapsed = scrubClock.restart() / 1000.0;
+    scrubPos = qMax(0.0, scrubPos + currentRate * elapsed);
+    if (state->duration > 0)
+        scrubPos = qMin(scrubPos, state->duration);
+    const bool atEdge = scrubPos <= 0 || (state->duration > 0 && scrubPos >= state->duration);
+
+    // The decoder is still on the last hop; skip ahead rather than queue
+    if (!atEdge && seeks->isBusy())
+        return;
+
+    const double keyframe = keyframes->atOrBefore(scrubPos);
+    const double target = keyframe >= 0 ? keyframe : scrubPos;
+    if (target != lastTarget) {
+        lastTarget = target;
+        seeks->seek(target, false);
+    }
+
+    if (atEdge)
+        setRate(0);
+}
+
+void Shuttle::step(int direction)
+{
+    if (!mpv)
+        return;
+
+    if (currentRate != 0) {
+        currentRate = 0;
+        scrubTimer->stop();
+        mpvSetAsync(mpv, "speed", 1.0);
+        emit rateChanged(0);
+    }
+
+    // Backward play direction decodes the GOP once for all steps through it;
+    // frame-back-step decodes it again from the keyframe for every frame
+    const bool reversed = direction < 0 && reverseCacheFits();
+    setBackward(reversed);
+
+    const char *cmd[] = {direction > 0 || reversed ? "frame-step" : "frame-back-step", nullptr};
+    if (mpv_command_async(mpv, AsyncFrameStep, cmd) < 0)
+        return;
+
+    stepIssuedNs = clock.nsecsElapsed();
+    awaitingStep = true;
+}
+
+void Shuttle::jumpKeyframe(int direction)
+{
+    if (!mpv)
+        return;
+
+    if (currentRate != 0)
+        setRate(0);
+    setBackward(false);
+
+    // Held arrow keys repeat faster than time-pos follows the seeks
+    const double from = seeks->isBusy() && lastTarget >= 0 ? lastTarget : state->timePos;
+    double target = direction > 0 ? keyframes->after(from) : keyframes->atOrBefore(from - kMinJumpSeconds);
+    if (target < 0) {
+        if (keyframes->isComplete())
+            return;
+        target = from + direction * kJumpSeconds;
+    }
+    target = qMax(0.0, target);
+    if (state->duration > 0)
+        target = qMin(target, state->duration);
+
+    lastTarget = target;
+    seeks->seek(target, false);
+}
+
+void Shuttle::release()
+{
+    if (currentRate != 0) {
+        currentRate = 0;
+        scrubTimer->stop();
+        if (mpv)
+            mpvSetAsync(mpv, "speed", 1.0);
+        emit rateChanged(0);
+    }
+    setBackward(false);
+}
+
+void Shuttle::setBackward(bool enabled)
+{
+    if (enabled == backward || !mpv)
+        return;
+
+    // Synchronous: the step queued right after must see the new direction
+    backward = enabled;
+    mpv_set_property_string(mpv, "play-dir", enabled ? "backward" : "forward");
+}
+
+bool Shuttle::reverseCacheFits() const
+{
+    const double start = keyframes->atOrBefore(state->timePos);
+    const double end = keyframes->after(state->timePos);
+    if (start < 0 || end < 0 || state->containerFps <= 0)
+        return false;
+
+    for (const TrackInfo &track : state->tracks) {
+        if (track.type != QLatin1String("video") || !track.selected || track.albumart)
+            continue;
+
+        // 8-bit 4:2:0 frames, the common case
+        const double frameBytes = track.width * double(track.height) * 1.5;
+        return frameBytes > 0 && (end - start) * state->containerFps * frameBytes <= kReverseCacheBytes;
+    }
+    return false;
+}
+
+void Shuttle::framePresented()
+{
+    if (!awaitingStep)
+        return;
+
+    stepRing.add((clock.nsecsElapsed() - stepIssuedNs) / 1000);
+    awaitingStep = false;
+}
+
+void Shuttle::setSource(const QString &name)
+{
+    if (stepRing.count() > 0) {
+        qInfo().noquote() << QString("Frame steps in %1: %2, p50 %3 ms, p95 %4 ms")
+                                 .arg(source)
+                                 .arg(stepRing.count())
+                                 .arg(stepRing.percentile(0.50) / 1000.0, 0, 'f', 2)
+                                 .arg(stepRing.percentile(0.95) / 1000.0, 0, 'f', 2);
+    }
+
+    stepRing.clear();
+    awaitingStep = false;
+    lastTarget = -1;
+    source = name;
+
+    // Speed and play direction are options and would carry over to the new file
+    release();
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <QObject>
+#include <QElapsedTimer>
+#include <QString>
+#include <QTimer>
+#include <mpv/client.h>
+#include "framestats.h"
+#include "keyframeindex.h"
+#include "playerstate.h"
+#include "seekscheduler.h"
+
+// J/K/L transport for reviewing footage: variable forward and reverse rates,
+// frame steps both ways and keyframe jumps. Forward rates up to 2x play
+// through mpv's speed; faster ones and all reverse rates hop from keyframe to
+// keyframe with seeks, one decoded frame per hop instead of every frame in
+// between.
+class Shuttle : public QObject
+{
+    Q_OBJECT
+
+public:
+    Shuttle(SeekScheduler *seeks, const PlayerState *state, const KeyframeIndex *keyframes,
+            QObject *parent = nullptr);
+
+    void setHandle(mpv_handle *handle);
+
+    // L and J: start in that direction, or go one rate faster
+    void forward();
+    void reverse();
+    // K: stop and pause
+    void stop();
+    // One frame either way; stops the shuttle
+    void step(int direction);
+    // Previous or next keyframe from the current (or last requested) position
+    void jumpKeyframe(int direction);
+    // Back to plain 1x forward playback, pause state left alone
+    void release();
+
+    // Signed multiple of normal speed, 0 when not shuttling
+    int rate() const { return currentRate; }
+
+    // Fed from MpvWidget's paint path
+    void framePresented();
+
+    // New current file; logs the step latency of the previous one
+    void setSource(const QString &name);
+
+    // Time from a frame step command to the frame it shows (us)
+    const FrameTimeRing &stepLatency() const { return stepRing; }
+
+signals:
+    void rateChanged(int rate);
+
+private:
+    void setRate(int rate);
+    void scrubTick();
+    void setBackward(bool backward);
+    bool reverseCacheFits() const;
+
+    SeekScheduler *seeks;
+    const PlayerState *state;
+    const KeyframeIndex *keyframes;
+    mpv_handle *mpv = nullptr;
+
+    int currentRate = 0;
+    bool backward = false;   // mpv's play-dir
+    QTimer *scrubTimer;
+    QElapsedTimer scrubClock;
+    double scrubPos = 0;
+    double lastTarget = -1;
+
+    QString source;
+    QElapsedTimer clock;
+    qint64 stepIssuedNs = 0;
+    bool awaitingStep = false;
+    FrameTimeRing stepRing;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Bounded lock-free single-producer/single-consumer ring. One slot is kept
+// free to tell full from empty, so it holds Capacity - 1 items.
+template <typename T, std::size_t Capacity>
+class SpscQueue
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+
+public:
+    // Producer side. Leaves item untouched and returns false when full.
+    bool push(T &&item)
+    {
+        const std::size_t tail = tailIndex.load(std::memory_order_relaxed);
+        const std::size_t next = (tail + 1) & (Capacity - 1);
+        if (next == headIndex.load(std::memory_order_acquire))
+            return false;
+
+        slots[tail] = std::move(item);
+        tailIndex.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    bool pop(T &out)
+    {
+        const std::size_t head = headIndex.load(std::memory_order_relaxed);
+        if (head == tailIndex.load(std::memory_order_acquire))
+            return false;
+
+        out = std::move(slots[head]);
+        headIndex.store((head + 1) & (Capacity - 1), std::memory_order_release);
+        return true;
+    }
+
+    bool isEmpty() const
+    {
+        return headIndex.load(std::memory_order_acquire) == tailIndex.load(std::memory_order_acquire);
+    }
+
+private:
+    std::array<T, Capacity> slots{};
+    alignas(64) std::atomic<std::size_t> headIndex{0};
+    alignas(64) std::atomic<std::size_t> tailIndex{0};
+};
@@ -0,0 +1,95 @@
+#include "startuptrace.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <atomic>
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+static QElapsedTimer g_clock;
+static double g_processAgeAtBeginMs = 0;
+static std::atomic<qint64> g_marksNs[StartupTrace::PhaseCount];
+static std::atomic<bool> g_printOnFirstFrame{false};
+
+static const char *phaseName(StartupTrace::Phase phase)
+{
+    switch (phase) {
+    case StartupTrace::MainEntered: return "main entered";
+    case StartupTrace::WindowShown: return "window shown";
+    case StartupTrace::MpvReady:    return "mpv ready";
+    case StartupTrace::FileLoaded:  return "file loaded";
+    case StartupTrace::FirstFrame:  return "first frame presented";
+    default:                        return "?";
+    }
+}
+
+// How long the process existed before main() (dynamic loading, static init).
+// Linux only; the kernel reports start time in clock ticks.
+static double processAgeMs()
+{
+#ifdef Q_OS_LINUX
+    QFile statFile("/proc/self/stat");
+    QFile uptimeFile("/proc/uptime");
+    if (!statFile.open(QIODevice::ReadOnly) || !uptimeFile.open(QIODevice::ReadOnly))
+        return 0;
+
+    // Fields after the parenthesised command name start at field 3 (state)
+    const QByteArray stat = statFile.readAll();
+    const QList<QByteArray> fields = stat.mid(stat.lastIndexOf(')') + 2).split(' ');
+    if (fields.size() < 20)
+        return 0;
+
+    const double startTicks = fields.at(19).toDouble();
+    const double uptime = uptimeFile.readAll().split(' ').value(0).toDouble();
+    const long ticksPerSecond = sysconf(_SC_CLK_TCK);
+    if (ticksPerSecond <= 0)
+        return 0;
+
+    return qMax(0.0, (uptime - startTicks / ticksPerSecond) * 1000.0);
+#else
+    return 0;
+#endif
+}
+
+void StartupTrace::begin()
+{
+    for (auto &mark : g_marksNs)
+        mark.store(-1);
+
+    g_clock.start();
+    g_processAgeAtBeginMs = processAgeMs();
+    mark(MainEntered);
+}
+
+void StartupTrace::mark(Phase phase)
+{
+    if (!g_clock.isValid() || phase < 0 || phase >= PhaseCount)
+        return;
+
+    qint64 expected = -1;
+    if (!g_marksNs[phase].compare_exchange_strong(expected, g_clock.nsecsElapsed()))
+        return;
+
+    if (phase == FirstFrame && g_printOnFirstFrame.load())
+        qInfo().noquote() << report();
+}
+
+void StartupTrace::setPrintOnFirstFrame(bool enabled)
+{
+    g_printOnFirstFrame.store(enabled);
+}
+
+QString StartupTrace::report()
+{
+    QString out = QStringLiteral("Startup trace (ms since process start):\n");
+    out += QString("  %1 %2\n").arg(QStringLiteral("process start"), -24).arg(0.0, 9, 'f', 1);
+
+    for (int i = 0; i < PhaseCount; ++i) {
+        const qint64 ns = g_marksNs[i].load();
+        const QString value = ns < 0 ? QStringLiteral("-")
+                                     : QString::number(g_processAgeAtBeginMs + ns / 1e6, 'f', 1);
+        out += QString("  %1 %2\n").arg(QString::fromLatin1(phaseName(static_cast<Phase>(i))), -24).arg(value, 9);
+    }
+    return out;
+}
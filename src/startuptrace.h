@@ -0,0 +1,25 @@
+#pragma once
+#include <QString>
+
+// Timestamps of the startup phases, relative to process start. Marks may come
+// from any thread; only the first mark of each phase counts.
+class StartupTrace
+{
+public:
+    enum Phase {
+        MainEntered,
+        WindowShown,
+        MpvReady,
+        FileLoaded,
+        FirstFrame,
+        PhaseCount
+    };
+
+    // Call first thing in main()
+    static void begin();
+    static void mark(Phase phase);
+
+    // Print the trace once the first frame is presented (--startup-trace)
+    static void setPrintOnFirstFrame(bool enabled);
+    static QString report();
+};
@@ -0,0 +1,83 @@
+#include "statsoverlay.h"
+#include <QPainter>
+#include <QFontDatabase>
+
+static constexpr int kPadding = 10;
+static constexpr int kGraphHeight = 48;
+
+StatsOverlay::StatsOverlay(QWidget *parent)
+: QWidget(parent)
+{
+    setAttribute(Qt::WA_TranslucentBackground, true);
+    setAttribute(Qt::WA_NoSystemBackground, true);
+    setAttribute(Qt::WA_TransparentForMouseEvents, true);
+
+    QFont mono = QFontDatabase::systemFont(QFontDatabase::FixedFont);
+    mono.setPointSize(9);
+    setFont(mono);
+
+    hide();
+}
+
+void StatsOverlay::setLines(const QStringList &newLines)
+{
+    lines = newLines;
+
+    const QFontMetrics fm(font());
+    int w = 0;
+    for (const QString &line : lines)
+        w = qMax(w, fm.horizontalAdvance(line));
+
+    const int h = lines.size() * fm.height() + kGraphHeight + 3 * kPadding;
+    resize(w + 2 * kPadding, h);
+    update();
+}
+
+void StatsOverlay::setFrameHistory(const QVector<qint64> &intervalsUs, qint64 targetUs)
+{
+    history = intervalsUs;
+    targetIntervalUs = targetUs;
+    update();
+}
+
+void StatsOverlay::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(0, 0, 0, 170));
+
+    // Text block
+    const QFontMetrics fm(font());
+    painter.setPen(QColor(230, 230, 230));
+    int y = kPadding + fm.ascent();
+    for (const QString &line : lines) {
+        painter.drawText(kPadding, y, line);
+        y += fm.height();
+    }
+
+    // Frame interval graph: one bar per paint, red when above 1.5x the target
+    if (history.isEmpty())
+        return;
+
+    const QRect graph(kPadding, height() - kPadding - kGraphHeight,
+                      width() - 2 * kPadding, kGraphHeight);
+    painter.fillRect(graph, QColor(255, 255, 255, 20));
+
+    const qint64 scaleUs = qMax<qint64>(1, targetIntervalUs > 0 ? 3 * targetIntervalUs : 50000);
+    const int bars = qMin<int>(history.size(), graph.width());
+    const int first = history.size() - bars;
+    for (int i = 0; i < bars; ++i) {
+        const qint64 v = history[first + i];
+        const int h = qMin<int>(kGraphHeight, static_cast<int>(v * kGraphHeight / scaleUs));
+        const bool late = targetIntervalUs > 0 && v > targetIntervalUs * 3 / 2;
+        painter.fillRect(graph.left() + i, graph.bottom() - h + 1, 1, h,
+                         late ? QColor(240, 80, 80) : QColor(120, 220, 120));
+    }
+
+    if (targetIntervalUs > 0) {
+        const int ty = graph.bottom() - static_cast<int>(targetIntervalUs * kGraphHeight / scaleUs);
+        painter.setPen(QColor(255, 255, 255, 90));
+        painter.drawLine(graph.left(), ty, graph.right(), ty);
+    }
+}
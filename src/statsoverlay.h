@@ -0,0 +1,25 @@
+#pragma once
+#include <QWidget>
+#include <QStringList>
+#include <QVector>
+
+// Playback-health HUD drawn over the video. It only displays what it is
+// given; MpvWidget collects the numbers while the overlay is visible.
+class StatsOverlay : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit StatsOverlay(QWidget *parent = nullptr);
+
+    void setLines(const QStringList &lines);
+    void setFrameHistory(const QVector<qint64> &intervalsUs, qint64 targetUs);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    QStringList lines;
+    QVector<qint64> history;
+    qint64 targetIntervalUs = 0;
+};
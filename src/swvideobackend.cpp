@@ -0,0 +1,275 @@
+#include "swvideobackend.h"
+#include <QDebug>
+#include <QPainter>
+#include <QResizeEvent>
+#include <new>
+
+// mpv writes B,G,R,X bytes, which is QImage::Format_RGB32 on little-endian hosts
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+static const char kSwFormat[] = "bgr0";
+#else
+static const char kSwFormat[] = "0rgb";
+#endif
+
+class SwVideoWidget : public QWidget
+{
+public:
+    SwVideoWidget(SwVideoBackend *backend, QWidget *parent) : QWidget(parent), backend(backend)
+    {
+        // Every pixel is painted; nothing underneath needs to be drawn first
+        setAttribute(Qt::WA_OpaquePaintEvent);
+        setMouseTracking(true);
+    }
+
+protected:
+    void paintEvent(QPaintEvent *) override
+    {
+        QPainter painter(this);
+        const QImage *frame = backend->shownFrame();
+        if (!frame) {
+            painter.fillRect(rect(), Qt::black);
+            return;
+        }
+
+        // Frames are rendered at device resolution; mid-resize the edges stay black
+        const QRect target(QPoint(0, 0), frame->deviceIndependentSize().toSize());
+        painter.drawImage(QPoint(0, 0), *frame);
+        painter.fillRect(QRect(target.right() + 1, 0, width() - target.width(), height()), Qt::black);
+        painter.fillRect(QRect(0, target.bottom() + 1, target.width(), height() - target.height()), Qt::black);
+    }
+
+    void resizeEvent(QResizeEvent *event) override
+    {
+        QWidget::resizeEvent(event);
+        backend->surfaceResized(event->size() * devicePixelRatio(), devicePixelRatio());
+    }
+
+private:
+    SwVideoBackend *backend;
+};
+
+SwVideoBackend::SwVideoBackend(QWidget *host)
+    : VideoBackend(host), surface(new SwVideoWidget(this, host))
+{
+}
+
+SwVideoBackend::~SwVideoBackend()
+{
+    detach();
+    for (Frame &frame : frames)
+        freeFrame(frame);
+}
+
+QWidget *SwVideoBackend::widget() const
+{
+    return surface;
+}
+
+void SwVideoBackend::attach(mpv_handle *handle)
+{
+    if (renderContext)
+        return;
+
+    mpv_render_param params[] = {
+        {MPV_RENDER_PARAM_API_TYPE, const_cast<char*>(MPV_RENDER_API_TYPE_SW)},
+        {MPV_RENDER_PARAM_INVALID, nullptr}
+    };
+
+    if (mpv_render_context_create(&renderContext, handle, params) < 0) {
+        qWarning() << "Failed to create MPV software render context";
+        renderContext = nullptr;
+        emit failed();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = false;
+        wakeRequested = true;
+        targetDpr = surface->devicePixelRatio();
+        targetSize = surface->size() * targetDpr;
+    }
+
+    renderThread = QThread::create([this]() { renderLoop(); });
+    renderThread->setObjectName("mpv sw render");
+    renderThread->start();
+
+    // Only the render thread touches the context from here on
+    mpv_render_context_set_update_callback(renderContext, onUpdate, this);
+    emit attached();
+}
+
+void SwVideoBackend::detach()
+{
+    if (!renderContext)
+        return;
+
+    mpv_render_context_set_update_callback(renderContext, nullptr, nullptr);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeCondition.notify_one();
+    renderThread->wait();
+    delete renderThread;
+    renderThread = nullptr;
+
+    mpv_render_context_free(renderContext);
+    renderContext = nullptr;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    shownIndex = -1;
+    pendingIndex = -1;
+    surface->update();
+}
+
+void SwVideoBackend::surfaceResized(const QSize &devicePixels, qreal dpr)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        targetSize = devicePixels;
+        targetDpr = dpr;
+    }
+    wake();
+}
+
+const QImage *SwVideoBackend::shownFrame() const
+{
+    // shownIndex only changes on the GUI thread, and the render thread never
+    // writes the shown buffer
+    return shownIndex >= 0 ? &frames[shownIndex].image : nullptr;
+}
+
+void SwVideoBackend::onUpdate(void *ctx)
+{
+    auto *self = static_cast<SwVideoBackend *>(ctx);
+    if (!self->deferRedraw())
+        self->wake();
+}
+
+void SwVideoBackend::wake()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        wakeRequested = true;
+    }
+    wakeCondition.notify_one();
+}
+
+void SwVideoBackend::renderLoop()
+{
+    QSize renderedSize;
+
+    for (;;) {
+        QSize size;
+        qreal dpr = 1;
+        int index = -1;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeCondition.wait(lock, [this]() { return wakeRequested || stopping; });
+            if (stopping)
+                return;
+            wakeRequested = false;
+            size = targetSize;
+
+            dpr = targetDpr;
+
+            // At most one buffer is shown and one waiting, so one is always free
+            for (int i = 0; i < kPoolSize && index < 0; ++i) {
+                if (i != shownIndex && i != pendingIndex)
+                    index = i;
+            }
+        }
+
+        // Nothing new from mpv and the surface did not change size: skip the render
+        const uint64_t flags = mpv_render_context_update(renderContext);
+        if (!(flags & MPV_RENDER_UPDATE_FRAME) && size == renderedSize)
+            continue;
+        if (size.isEmpty())
+            continue;
+
+        Frame &frame = frames[index];
+        if (!prepareFrame(frame, size, dpr))
+            continue;
+
+        int swSize[2] = {size.width(), size.height()};
+        size_t stride = static_cast<size_t>(frame.image.bytesPerLine());
+        mpv_render_param params[] = {
+            {MPV_RENDER_PARAM_SW_SIZE, swSize},
+            {MPV_RENDER_PARAM_SW_FORMAT, const_cast<char *>(kSwFormat)},
+            {MPV_RENDER_PARAM_SW_STRIDE, &stride},
+            {MPV_RENDER_PARAM_SW_POINTER, frame.data},
+            {MPV_RENDER_PARAM_INVALID, nullptr}
+        };
+
+        frame.renderStartNs = clock.nsecsElapsed();
+        const int status = mpv_render_context_render(renderContext, params);
+        frame.renderEndNs = clock.nsecsElapsed();
+        if (status < 0) {
+            qWarning() << "MPV software render failed:" << mpv_error_string(status);
+            continue;
+        }
+        renderedSize = size;
+
+        // A frame still waiting to be shown is simply superseded
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pendingIndex = index;
+        }
+        if (!presentQueued.exchange(true))
+            QMetaObject::invokeMethod(this, &SwVideoBackend::present, Qt::QueuedConnection);
+    }
+}
+
+bool SwVideoBackend::prepareFrame(Frame &frame, const QSize &size, qreal dpr)
+{
+    const qsizetype stride = (static_cast<qsizetype>(size.width()) * 4 + kAlignment - 1) & ~qsizetype(kAlignment - 1);
+    const size_t bytes = static_cast<size_t>(stride) * size.height();
+
+    // Buffers only grow, so resizing back and forth does not reallocate
+    if (bytes > frame.capacity) {
+        freeFrame(frame);
+        frame.data = static_cast<uchar *>(::operator new(bytes, std::align_val_t(kAlignment), std::nothrow));
+        if (!frame.data)
+            return false;
+        frame.capacity = bytes;
+    }
+
+    if (frame.image.size() != size || frame.image.constBits() != frame.data
+        || frame.image.devicePixelRatio() != dpr) {
+        frame.image = QImage(frame.data, size.width(), size.height(), stride, QImage::Format_RGB32);
+        frame.image.setDevicePixelRatio(dpr);
+    }
+    return true;
+}
+
+void SwVideoBackend::freeFrame(Frame &frame)
+{
+    frame.image = QImage();
+    if (frame.data)
+        ::operator delete(frame.data, std::align_val_t(kAlignment));
+    frame.data = nullptr;
+    frame.capacity = 0;
+}
+
+void SwVideoBackend::present()
+{
+    presentQueued = false;
+
+    int index;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (pendingIndex < 0)
+            return;
+        shownIndex = pendingIndex;
+        pendingIndex = -1;
+        index = shownIndex;
+    }
+
+    if (frameStats)
+        frameStats->recordFrame(frames[index].renderStartNs, frames[index].renderEndNs);
+
+    surface->update();
+    emit framePresented();
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <QImage>
+#include <QSize>
+#include <QThread>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <mpv/render.h>
+#include "videobackend.h"
+
+class SwVideoWidget;
+
+// mpv's software render API for machines without usable GL. A render thread
+// waits for mpv to report a new frame, renders it into one of a few reused,
+// 64-byte aligned buffers and hands it to the GUI, which paints that memory
+// through a QImage wrapper without copying it.
+class SwVideoBackend : public VideoBackend
+{
+    Q_OBJECT
+
+public:
+    explicit SwVideoBackend(QWidget *host);
+    ~SwVideoBackend() override;
+
+    Mode mode() const override { return Software; }
+    QWidget *widget() const override;
+
+    void attach(mpv_handle *handle) override;
+    void detach() override;
+    bool isAttached() const override { return renderContext != nullptr; }
+    void redraw() override { wake(); }
+
+    // Called by the surface on the GUI thread
+    void surfaceResized(const QSize &devicePixels, qreal dpr);
+    const QImage *shownFrame() const;
+
+private slots:
+    void present();
+
+private:
+    struct Frame
+    {
+        uchar *data = nullptr;
+        size_t capacity = 0;
+        QImage image;            // wraps data
+        qint64 renderStartNs = 0;
+        qint64 renderEndNs = 0;
+    };
+
+    static constexpr int kPoolSize = 3;   // shown, waiting to be shown, being rendered
+    static constexpr size_t kAlignment = 64;
+
+    static void onUpdate(void *ctx);
+    void wake();
+    void renderLoop();
+    bool prepareFrame(Frame &frame, const QSize &size, qreal dpr);
+    static void freeFrame(Frame &frame);
+
+    SwVideoWidget *surface;
+    mpv_render_context *renderContext = nullptr;
+    QThread *renderThread = nullptr;
+
+    // Shared with the render thread
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    bool wakeRequested = false;
+    bool stopping = false;
+    QSize targetSize;
+    qreal targetDpr = 1;
+    int shownIndex = -1;
+    int pendingIndex = -1;
+    std::atomic<bool> presentQueued{false};
+
+    Frame frames[kPoolSize];
+};
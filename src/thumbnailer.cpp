@@ -0,0 +1,364 @@
+#include "thumbnailer.h"
+#include "fileidentity.h"
+#include "mpvcore.h"
+#include <QDebug>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <algorithm>
+#include <QMutexLocker>
+#include <QStandardPaths>
+
+static constexpr int kThumbWidth = 192;          // multiple of 16 keeps the stride 64-byte aligned
+static constexpr int kPrefetchAhead = 4;
+static constexpr qint64 kDefaultMemoryBudget = 32 * 1024 * 1024;
+// Disk cache cap; a sweep trims it well below so sweeps stay rare
+static constexpr qint64 kDiskCacheLimit = 256 * 1024 * 1024;
+static constexpr qint64 kDiskCacheTarget = kDiskCacheLimit * 3 / 4;
+
+ThumbnailWorker::ThumbnailWorker(int thumbWidth, QObject *parent)
+: QThread(parent)
+, thumbWidth(thumbWidth)
+{
+    setObjectName("thumbnailer");
+}
+
+ThumbnailWorker::~ThumbnailWorker()
+{
+    stop();
+}
+
+void ThumbnailWorker::schedule(const QList<ThumbnailJob> &jobs)
+{
+    QMutexLocker lock(&mutex);
+    queue = jobs;
+    wakeup.wakeOne();
+}
+
+void ThumbnailWorker::stop()
+{
+    {
+        QMutexLocker lock(&mutex);
+        stopping = true;
+        queue.clear();
+        wakeup.wakeOne();
+    }
+    wait();
+}
+
+bool ThumbnailWorker::takeJob(ThumbnailJob &job)
+{
+    QMutexLocker lock(&mutex);
+    while (queue.isEmpty() && !stopping)
+        wakeup.wait(&mutex);
+
+    if (stopping)
+        return false;
+
+    job = queue.takeFirst();
+    return true;
+}
+
+void ThumbnailWorker::run()
+{
+    // Video only, keyframes only
+    mpv = createSecondaryMpv("Thumbnailer", {
+        {"vo", "libmpv"},
+        {"aid", "no"},
+        {"sid", "no"},
+        {"audio-display", "no"},
+        {"hwdec", "no"},
+        {"pause", "yes"},
+        {"keep-open", "always"},
+        {"hr-seek", "no"},
+        {"vd-lavc-skipframe", "nonkey"},
+        {"vd-lavc-skiploopfilter", "all"},
+        {"vd-lavc-fast", "yes"},
+        {"vd-lavc-threads", "2"},
+        {"cache", "no"},
+        {"demuxer-readahead-secs", "0"},
+    });
+    if (!mpv)
+        return;
+
+    mpv_render_param params[] = {
+        {MPV_RENDER_PARAM_API_TYPE, const_cast<char *>(MPV_RENDER_API_TYPE_SW)},
+        {MPV_RENDER_PARAM_INVALID, nullptr}
+    };
+    if (mpv_render_context_create(&renderCtx, mpv, params) < 0) {
+        qWarning() << "Thumbnailer: software render API unavailable";
+        mpv_destroy(mpv);
+        mpv = nullptr;
+        return;
+    }
+
+    // Called from mpv's threads whenever the SW context has something new
+    mpv_render_context_set_update_callback(renderCtx, [](void *ctx) {
+        static_cast<ThumbnailWorker *>(ctx)->frameAvailable.store(true);
+    }, this);
+
+    ThumbnailJob job;
+    while (takeJob(job)) {
+        // Disk cache hit: no decoding at all
+        const QString diskPath = job.diskDir.isEmpty()
+            ? QString() : QDir(job.diskDir).filePath(QString::number(job.bucketMs) + ".jpg");
+        if (!diskPath.isEmpty() && QFileInfo::exists(diskPath)) {
+            QImage image(diskPath);
+            if (!image.isNull()) {
+                // Modification time is the last use for eviction
+                QFile used(diskPath);
+                if (used.open(QIODevice::ReadOnly))
+                    used.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+                emit thumbnailReady(job.generation, job.bucketMs, image, -1);
+                continue;
+            }
+        }
+
+        if (job.path != loadedPath && !openFile(job.path))
+            continue;
+
+        const QByteArray pos = QByteArray::number(job.bucketMs / 1000.0, 'f', 3);
+        const char *seek[] = {"seek", pos.constData(), "absolute+keyframes", nullptr};
+        frameAvailable.store(false);
+        if (mpv_command(mpv, seek) < 0 || !waitForEvent(MPV_EVENT_PLAYBACK_RESTART, 3000))
+            continue;
+        if (!waitForFrame(2000))
+            continue;
+
+        QImage image = renderFrame();
+        if (image.isNull())
+            continue;
+
+        // With keyframe seeks the frame shown is a keyframe; its time feeds the keyframe index
+        double keyframeTime = -1;
+        mpv_get_property(mpv, "time-pos", MPV_FORMAT_DOUBLE, &keyframeTime);
+
+        if (!diskPath.isEmpty()) {
+            QDir().mkpath(job.diskDir);
+            if (image.save(diskPath, "JPG", 80)) {
+                const QString root = QFileInfo(job.diskDir).path();
+                if (diskBytes < 0 || (diskBytes += QFileInfo(diskPath).size()) > kDiskCacheLimit)
+                    sweepDiskCache(root);
+            }
+        }
+
+        emit thumbnailReady(job.generation, job.bucketMs, image, keyframeTime);
+    }
+
+    mpv_render_context_free(renderCtx);
+    renderCtx = nullptr;
+    mpv_destroy(mpv);
+    mpv = nullptr;
+}
+
+bool ThumbnailWorker::openFile(const QString &path)
+{
+    const QByteArray file = path.toUtf8();
+    const char *cmd[] = {"loadfile", file.constData(), nullptr};
+    if (mpv_command(mpv, cmd) < 0 || !waitForEvent(MPV_EVENT_FILE_LOADED, 5000)) {
+        loadedPath.clear();
+        return false;
+    }
+
+    loadedPath = path;
+    return true;
+}
+
+void ThumbnailWorker::sweepDiskCache(const QString &root)
+{
+    struct CachedImage
+    {
+        QDateTime used;
+        QString path;
+        qint64 size;
+    };
+
+    QList<CachedImage> images;
+    qint64 total = 0;
+    QDirIterator it(root, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        const QFileInfo info = it.fileInfo();
+        images.append({info.lastModified(), info.filePath(), info.size()});
+        total += info.size();
+    }
+
+    if (total > kDiskCacheLimit) {
+        std::sort(images.begin(), images.end(), [](const CachedImage &a, const CachedImage &b) {
+            return a.used < b.used;
+        });
+        for (const CachedImage &image : std::as_const(images)) {
+            if (total <= kDiskCacheTarget)
+                break;
+            if (QFile::remove(image.path))
+                total -= image.size;
+        }
+
+        // Directories of edited or long-gone files end up empty; rmdir leaves the rest
+        QDir rootDir(root);
+        for (const QString &dir : rootDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+            rootDir.rmdir(dir);
+    }
+
+    diskBytes = total;
+}
+
+bool ThumbnailWorker::waitForEvent(mpv_event_id id, int timeoutMs)
+{
+    return waitForMpvEvent(mpv, id, timeoutMs, [this]() {
+        QMutexLocker lock(&mutex);
+        return stopping;
+    });
+}
+
+bool ThumbnailWorker::waitForFrame(int timeoutMs)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    while (timer.elapsed() < timeoutMs) {
+        if (frameAvailable.exchange(false)
+            && (mpv_render_context_update(renderCtx) & MPV_RENDER_UPDATE_FRAME)) {
+            return true;
+        }
+        // Keep mpv's event queue drained while waiting
+        mpv_wait_event(mpv, 0.01);
+    }
+    return false;
+}
+
+QImage ThumbnailWorker::renderFrame()
+{
+    int64_t dw = 0, dh = 0;
+    mpv_get_property(mpv, "dwidth", MPV_FORMAT_INT64, &dw);
+    mpv_get_property(mpv, "dheight", MPV_FORMAT_INT64, &dh);
+
+    const int w = thumbWidth;
+    int h = (dw > 0 && dh > 0) ? static_cast<int>(w * dh / dw) : w * 9 / 16;
+    h = qMax(2, h & ~1);
+
+    size_t stride = static_cast<size_t>(w) * 4;
+    frameBuffer.resize(static_cast<int>(stride * h));
+
+    int size[2] = {w, h};
+    const char *format = "rgb0";
+    mpv_render_param params[] = {
+        {MPV_RENDER_PARAM_SW_SIZE, size},
+        {MPV_RENDER_PARAM_SW_FORMAT, const_cast<char *>(format)},
+        {MPV_RENDER_PARAM_SW_STRIDE, &stride},
+        {MPV_RENDER_PARAM_SW_POINTER, frameBuffer.data()},
+        {MPV_RENDER_PARAM_INVALID, nullptr}
+    };
+
+    if (mpv_render_context_render(renderCtx, params) < 0)
+        return QImage();
+
+    // Detach from the reused buffer; thumbnails are small
+    return QImage(reinterpret_cast<const uchar *>(frameBuffer.constData()), w, h,
+                  static_cast<qsizetype>(stride), QImage::Format_RGBX8888).copy();
+}
+
+Thumbnailer::Thumbnailer(QObject *parent)
+: QObject(parent)
+{
+    cache.setMaxCost(static_cast<int>(kDefaultMemoryBudget / 1024));
+
+    worker = new ThumbnailWorker(kThumbWidth, this);
+    connect(worker, &ThumbnailWorker::thumbnailReady, this, &Thumbnailer::onWorkerResult,
+            Qt::QueuedConnection);
+    worker->start(QThread::LowPriority);
+}
+
+Thumbnailer::~Thumbnailer()
+{
+    worker->stop();
+}
+
+void Thumbnailer::setSource(const QString &url)
+{
+    generation++;
+    cache.clear();
+    hoveredBucketMs = -1;
+    lastBucketMs = -1;
+    worker->schedule({});
+
+    // Keyed by file identity, so edited files get fresh thumbnails
+    const QString id = fileIdentity(url, &sourcePath);
+    if (id.isEmpty()) {
+        sourcePath.clear();
+        sourceDiskDir.clear();
+        return;
+    }
+
+    sourceDiskDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+        + "/thumbnails/" + id;
+}
+
+void Thumbnailer::setMemoryBudget(qint64 bytes)
+{
+    if (bytes < 0)
+        bytes = kDefaultMemoryBudget;
+    cache.setMaxCost(static_cast<int>(qMax<qint64>(1, bytes / 1024)));
+}
+
+qint64 Thumbnailer::bucketSpanMs(double duration) const
+{
+    return qMax<qint64>(1000, static_cast<qint64>(duration * 1000 / 600));
+}
+
+QImage Thumbnailer::request(double seconds, double duration)
+{
+    if (!isEnabled() || duration <= 0)
+        return QImage();
+
+    const qint64 span = bucketSpanMs(duration);
+    const qint64 durationMs = static_cast<qint64>(duration * 1000);
+    const qint64 bucket = qBound<qint64>(0, static_cast<qint64>(seconds * 1000), durationMs) / span * span;
+
+    if (bucket == hoveredBucketMs) {
+        QImage *cached = cache.object(bucket);
+        return cached ? *cached : QImage();
+    }
+
+    const int direction = (lastBucketMs >= 0 && bucket < lastBucketMs) ? -1 : 1;
+    lastBucketMs = bucket;
+    hoveredBucketMs = bucket;
+
+    // Hovered bucket first, then a few ahead in the direction the cursor moves
+    QList<ThumbnailJob> jobs;
+    for (int i = 0; i <= kPrefetchAhead; ++i) {
+        const qint64 b = bucket + direction * i * span;
+        if (b < 0 || b > durationMs)
+            break;
+        if (cache.contains(b))
+            continue;
+
+        ThumbnailJob job;
+        job.generation = generation;
+        job.path = sourcePath;
+        job.diskDir = diskCacheEnabled ? sourceDiskDir : QString();
+        job.bucketMs = b;
+        jobs.append(job);
+    }
+    worker->schedule(jobs);
+
+    QImage *cached = cache.object(bucket);
+    return cached ? *cached : QImage();
+}
+
+void Thumbnailer::onWorkerResult(quint64 resultGeneration, qint64 bucketMs, const QImage &image, double keyframeTime)
+{
+    if (resultGeneration != generation)
+        return;
+
+    cache.insert(bucketMs, new QImage(image), qMax<int>(1, static_cast<int>(image.sizeInBytes() / 1024)));
+
+    if (keyframeTime >= 0)
+        emit keyframeFound(keyframeTime);
+
+    if (bucketMs == hoveredBucketMs)
+        emit thumbnailReady(bucketMs / 1000.0, image);
+}
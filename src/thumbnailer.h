@@ -0,0 +1,106 @@
+#pragma once
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QCache>
+#include <QImage>
+#include <QList>
+#include <QString>
+#include <atomic>
+#include <mpv/client.h>
+#include <mpv/render.h>
+
+// One thumbnail to produce on the worker
+struct ThumbnailJob
+{
+    quint64 generation = 0;
+    QString path;
+    QString diskDir;   // empty when the disk cache is off
+    qint64 bucketMs = 0;
+};
+
+// Secondary, video-only mpv instance rendering keyframes through the software
+// render API on its own thread, so the main decode never waits on it.
+class ThumbnailWorker : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit ThumbnailWorker(int thumbWidth, QObject *parent = nullptr);
+    ~ThumbnailWorker() override;
+
+    // Replaces all queued work; the first job is the one under the cursor
+    void schedule(const QList<ThumbnailJob> &jobs);
+    void stop();
+
+signals:
+    void thumbnailReady(quint64 generation, qint64 bucketMs, const QImage &image, double keyframeTime);
+
+protected:
+    void run() override;
+
+private:
+    bool takeJob(ThumbnailJob &job);
+    bool openFile(const QString &path);
+    void sweepDiskCache(const QString &root);
+    bool waitForEvent(mpv_event_id id, int timeoutMs);
+    bool waitForFrame(int timeoutMs);
+    QImage renderFrame();
+
+    const int thumbWidth;
+    QMutex mutex;
+    QWaitCondition wakeup;
+    QList<ThumbnailJob> queue;
+    bool stopping = false;
+
+    // Owned by the worker thread
+    mpv_handle *mpv = nullptr;
+    mpv_render_context *renderCtx = nullptr;
+    QString loadedPath;
+    QByteArray frameBuffer;
+    std::atomic<bool> frameAvailable{false};
+    qint64 diskBytes = -1;   // disk cache size; unknown until the first sweep
+};
+
+// GUI-side front end: memory-bounded LRU of downscaled frames, optional disk
+// cache keyed by file identity and timestamp, prefetch ahead of the cursor.
+// The disk cache is capped; the least recently used images go first.
+class Thumbnailer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit Thumbnailer(QObject *parent = nullptr);
+    ~Thumbnailer() override;
+
+    // Only local files get previews; anything else disables them
+    void setSource(const QString &url);
+    bool isEnabled() const { return !sourcePath.isEmpty(); }
+
+    // Returns the cached image for the bucket at `seconds` right away when
+    // available, otherwise schedules it and emits thumbnailReady later.
+    QImage request(double seconds, double duration);
+
+    // -1 for the default
+    void setMemoryBudget(qint64 bytes);
+    qint64 memoryUsed() const { return cache.totalCost() * 1024; }
+    void setDiskCacheEnabled(bool enabled) { diskCacheEnabled = enabled; }
+
+signals:
+    void thumbnailReady(double seconds, const QImage &image);
+    void keyframeFound(double seconds);
+
+private:
+    void onWorkerResult(quint64 generation, qint64 bucketMs, const QImage &image, double keyframeTime);
+    qint64 bucketSpanMs(double duration) const;
+
+    ThumbnailWorker *worker;
+    QCache<qint64, QImage> cache;   // cost in KiB
+    quint64 generation = 0;
+    QString sourcePath;
+    QString sourceDiskDir;
+    qint64 hoveredBucketMs = -1;
+    qint64 lastBucketMs = -1;
+    bool diskCacheEnabled = true;
+};
@@ -0,0 +1,76 @@
+#include "videobackend.h"
+#include <QDebug>
+#include <QOpenGLContext>
+#include "glvideobackend.h"
+#include "swvideobackend.h"
+
+// Headless machines and broken drivers fail here, long before mpv would
+static bool openGLAvailable()
+{
+    QOpenGLContext probe;
+    return probe.create();
+}
+
+VideoBackend *VideoBackend::create(Mode mode, QWidget *host)
+{
+    if (mode != Software && !openGLAvailable()) {
+        qWarning() << "No OpenGL context available; using software rendering";
+        mode = Software;
+    }
+
+    if (mode == Software)
+        return new SwVideoBackend(host);
+    return new GLVideoBackend(mode == Direct, host);
+}
+
+VideoBackend::VideoBackend(QObject *parent) : QObject(parent)
+{
+    clock.start();
+}
+
+bool VideoBackend::parseMode(const QString &name, Mode *mode)
+{
+    if (name == QLatin1String("composited") || name == QLatin1String("widget")) {
+        *mode = Composited;
+        return true;
+    }
+    if (name == QLatin1String("direct") || name == QLatin1String("window")) {
+        *mode = Direct;
+        return true;
+    }
+    if (name == QLatin1String("software") || name == QLatin1String("sw")) {
+        *mode = Software;
+        return true;
+    }
+    return false;
+}
+
+QString VideoBackend::modeName(Mode mode)
+{
+    switch (mode) {
+    case Composited: return QStringLiteral("composited");
+    case Direct:     return QStringLiteral("direct");
+    case Software:   return QStringLiteral("software");
+    }
+    return QString();
+}
+
+void VideoBackend::setFrameStats(FrameStats *stats)
+{
+    frameStats = stats;
+}
+
+void VideoBackend::setSuspended(bool suspend)
+{
+    suspended.store(suspend);
+    if (!suspend && redrawMissed.exchange(false))
+        redraw();
+}
+
+bool VideoBackend::deferRedraw()
+{
+    if (!suspended.load(std::memory_order_relaxed))
+        return false;
+    redrawMissed.store(true);
+    return true;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include <QWidget>
+#include <atomic>
+#include <mpv/client.h>
+#include "framestats.h"
+
+// Where mpv's frames end up. A backend owns the mpv render context and the
+// surface it draws into; MpvWidget lays the surface out underneath its controls.
+class VideoBackend : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Mode {
+        Composited,   // QOpenGLWidget: mpv draws into an FBO the backing store composites
+        Direct,       // QOpenGLWindow in a window container: mpv draws to the default framebuffer
+        Software      // mpv's CPU renderer into pooled images; no GL needed
+    };
+
+    // GL modes fall back to Software when no OpenGL context can be created
+    static VideoBackend *create(Mode mode, QWidget *host);
+    static bool parseMode(const QString &name, Mode *mode);
+    static QString modeName(Mode mode);
+
+    explicit VideoBackend(QObject *parent = nullptr);
+
+    virtual Mode mode() const = 0;
+    virtual QWidget *widget() const = 0;
+
+    // Create the render context as soon as the surface allows it; attached() follows
+    virtual void attach(mpv_handle *mpv) = 0;
+    // Free the render context; call before the handle is destroyed
+    virtual void detach() = 0;
+    virtual bool isAttached() const = 0;
+
+    // Repaint the current frame (GUI thread)
+    virtual void redraw() = 0;
+
+    // While suspended, mpv's redraw requests are only remembered; the last
+    // one is replayed on resume. For hidden or minimized windows.
+    void setSuspended(bool suspended);
+
+    // Render timings are recorded here while set
+    void setFrameStats(FrameStats *stats);
+
+signals:
+    void attached();
+    // The render context could not be created; the host should switch to Software
+    void failed();
+    // After every frame handed to the surface, on the GUI thread
+    void framePresented();
+
+protected:
+    // For mpv's update callback: true if the redraw should be skipped
+    bool deferRedraw();
+
+    FrameStats *frameStats = nullptr;
+    QElapsedTimer clock;
+
+private:
+    std::atomic<bool> suspended{false};
+    std::atomic<bool> redrawMissed{false};
+};
@@ -0,0 +1,382 @@
+#include "videowall.h"
+#include "mpvcore.h"
+#include <QDebug>
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLFramebufferObject>
+#include <QRegion>
+#include <QScreen>
+#include <QThread>
+#include <clocale>
+#include <cmath>
+
+VideoWall::VideoWall(QWidget *parent)
+    : QOpenGLWidget(parent), threadBudget(QThread::idealThreadCount())
+{
+    // mpv needs C number formatting; set before any tile core starts
+    setlocale(LC_NUMERIC, "C");
+
+    // Wakes the scheduler when the next throttled tile is due
+    throttleTimer = new QTimer(this);
+    throttleTimer->setSingleShot(true);
+    connect(throttleTimer, &QTimer::timeout, this, [this]() { update(); });
+
+    // A minimized or scrolled-away wall gets no repaints to notice it by
+    visibilityTimer = new QTimer(this);
+    visibilityTimer->setInterval(kVisibilityCheckMs);
+    connect(visibilityTimer, &QTimer::timeout, this, &VideoWall::updateVisibility);
+    visibilityTimer->start();
+
+    // mpv paces each tile against the presentation of the whole wall
+    connect(this, &QOpenGLWidget::frameSwapped, this, &VideoWall::reportSwaps);
+
+    clock.start();
+}
+
+VideoWall::~VideoWall()
+{
+    clearTiles();
+}
+
+// A core per tile, trimmed for many at once: no audio, small demuxer
+// buffers and a share of the decoder threads
+mpv_handle *VideoWall::createTileCore(int decodeThreads)
+{
+    const QByteArray threads = QByteArray::number(decodeThreads);
+    const QByteArray demuxerBytes = QByteArray::number(32 * 1024 * 1024);
+    return createRenderMpv("Wall tile", {
+        {"aid", "no"},
+        {"vd-lavc-threads", threads.constData()},
+        {"demuxer-max-bytes", demuxerBytes.constData()},
+        {"demuxer-max-back-bytes", "0"},
+        // Tiles share one render loop; a late tile drops frames instead of stalling the rest
+        {"framedrop", "decoder+vo"},
+        {"loop-file", "inf"},
+        {"idle", "yes"},
+    });
+}
+
+void VideoWall::setSources(const QStringList &urls)
+{
+    clearTiles();
+
+    const int perTile = qMax(1, threadBudget / qMax<int>(1, urls.size()));
+    for (const QString &url : urls) {
+        auto tile = std::make_unique<Tile>();
+        tile->wall = this;
+        tile->url = url;
+        tile->decodeThreads = perTile;
+        tile->coreFuture = std::async(std::launch::async, [this, perTile]() {
+            mpv_handle *handle = createTileCore(perTile);
+            QMetaObject::invokeMethod(this, &VideoWall::adoptCores, Qt::QueuedConnection);
+            return handle;
+        });
+        tiles.push_back(std::move(tile));
+    }
+
+    readyEmitted = false;
+    layoutTiles();
+    update();
+}
+
+void VideoWall::clearTiles()
+{
+    if (tiles.empty())
+        return;
+
+    // Render contexts free GL objects, so the shared context must be current
+    if (glReady)
+        makeCurrent();
+    for (auto &tile : tiles) {
+        if (tile->renderContext)
+            mpv_render_context_free(tile->renderContext);
+        delete tile->fbo;
+    }
+    if (glReady)
+        doneCurrent();
+
+    for (auto &tile : tiles) {
+        if (tile->coreFuture.valid())
+            tile->mpv = tile->coreFuture.get();
+        if (tile->mpv)
+            mpv_destroy(tile->mpv);
+    }
+    tiles.clear();
+}
+
+void VideoWall::adoptCores()
+{
+    bool pending = false;
+    for (auto &tile : tiles) {
+        if (tile->coreFuture.valid()) {
+            if (tile->coreFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                pending = true;
+                continue;
+            }
+            tile->mpv = tile->coreFuture.get();
+            if (tile->mpv)
+                mpv_set_wakeup_callback(tile->mpv, onWakeup, this);
+        }
+    }
+
+    // Without GL yet, initializeGL comes back here
+    if (!glReady)
+        return;
+
+    makeCurrent();
+    attachPending();
+    doneCurrent();
+
+    if (!pending && !readyEmitted) {
+        readyEmitted = true;
+        emit ready();
+    }
+}
+
+// Expects the shared context to be current
+void VideoWall::attachPending()
+{
+    for (auto &tile : tiles) {
+        if (tile->mpv && !tile->renderContext)
+            attachRenderContext(*tile);
+    }
+}
+
+void VideoWall::attachRenderContext(Tile &tile)
+{
+    mpv_opengl_init_params gl_init = {
+        .get_proc_address = [](void *, const char *name) -> void * {
+            return reinterpret_cast<void *>(QOpenGLContext::currentContext()->getProcAddress(name));
+        },
+        .get_proc_address_ctx = nullptr
+    };
+
+    mpv_render_param params[] = {
+        {MPV_RENDER_PARAM_API_TYPE, const_cast<char*>(MPV_RENDER_API_TYPE_OPENGL)},
+        {MPV_RENDER_PARAM_OPENGL_INIT_PARAMS, &gl_init},
+        {MPV_RENDER_PARAM_INVALID, nullptr}
+    };
+
+    int status = mpv_render_context_create(&tile.renderContext, tile.mpv, params);
+    if (status < 0) {
+        qWarning() << "Failed to create MPV OpenGL render context for" << tile.url;
+        tile.renderContext = nullptr;
+        return;
+    }
+
+    mpv_render_context_set_update_callback(tile.renderContext, onRenderUpdate, &tile);
+
+    QByteArray ba = tile.url.toUtf8();
+    const char *cmd[] = {"loadfile", ba.constData(), nullptr};
+    status = mpv_command(tile.mpv, cmd);
+    if (status < 0)
+        qWarning() << "Failed to load" << tile.url << ":" << mpv_error_string(status);
+}
+
+void VideoWall::initializeGL()
+{
+    glReady = true;
+    // Cores that came up before the context get their render contexts now
+    QMetaObject::invokeMethod(this, &VideoWall::adoptCores, Qt::QueuedConnection);
+}
+
+void VideoWall::resizeGL(int, int)
+{
+    layoutTiles();
+}
+
+void VideoWall::layoutTiles()
+{
+    const int count = tileCount();
+    if (count == 0)
+        return;
+
+    const int columns = static_cast<int>(std::ceil(std::sqrt(double(count))));
+    const int rows = (count + columns - 1) / columns;
+    const int tileWidth = (width() - kTileSpacing * (columns - 1)) / columns;
+    const int tileHeight = (height() - kTileSpacing * (rows - 1)) / rows;
+
+    for (int i = 0; i < count; ++i) {
+        const int column = i % columns;
+        const int row = i / columns;
+        tiles[i]->rect = QRect(column * (tileWidth + kTileSpacing), row * (tileHeight + kTileSpacing),
+                               qMax(1, tileWidth), qMax(1, tileHeight));
+        tiles[i]->updatePending = true;
+    }
+}
+
+// Runs on an mpv thread: mark the tile and queue at most one repaint
+void VideoWall::onRenderUpdate(void *ctx)
+{
+    auto *tile = static_cast<Tile *>(ctx);
+    tile->dirty = true;
+    tile->wall->scheduleRepaint();
+}
+
+void VideoWall::scheduleRepaint()
+{
+    if (!repaintQueued.exchange(true))
+        QMetaObject::invokeMethod(this, [this]() {
+            repaintQueued = false;
+            update();
+        }, Qt::QueuedConnection);
+}
+
+void VideoWall::onWakeup(void *ctx)
+{
+    auto *self = static_cast<VideoWall *>(ctx);
+    if (!self->eventsQueued.exchange(true))
+        QMetaObject::invokeMethod(self, &VideoWall::processEvents, Qt::QueuedConnection);
+}
+
+void VideoWall::processEvents()
+{
+    eventsQueued = false;
+    for (auto &tile : tiles) {
+        if (!tile->mpv)
+            continue;
+        while (true) {
+            mpv_event *event = mpv_wait_event(tile->mpv, 0);
+            if (event->event_id == MPV_EVENT_NONE)
+                break;
+            if (event->event_id == MPV_EVENT_END_FILE) {
+                auto *end = static_cast<mpv_event_end_file *>(event->data);
+                if (end->reason == MPV_END_FILE_REASON_ERROR)
+                    qWarning() << "Wall tile failed:" << tile->url << ":" << mpv_error_string(end->error);
+            }
+        }
+    }
+}
+
+void VideoWall::paintGL()
+{
+    QOpenGLExtraFunctions *gl = context()->extraFunctions();
+    gl->glClearColor(0.08f, 0.08f, 0.08f, 1.0f);
+    gl->glClear(GL_COLOR_BUFFER_BIT);
+
+    const qreal dpr = devicePixelRatio();
+    const int targetHeight = static_cast<int>(height() * dpr);
+    updateVisibility();
+    const qint64 now = clock.nsecsElapsed();
+    const qint64 hiddenIntervalNs = 1000000000LL / kHiddenFps;
+    qint64 nextDueNs = -1;
+
+    for (auto &tile : tiles) {
+        if (!tile->renderContext)
+            continue;
+
+        if (tile->dirty.exchange(false))
+            tile->updatePending = true;
+
+        const QSize pixelSize = tile->rect.size() * dpr;
+        if (tile->updatePending) {
+            const qint64 dueNs = tile->visible ? 0 : tile->lastRenderNs + hiddenIntervalNs;
+            if (now >= dueNs) {
+                tile->updatePending = false;
+                renderTile(*tile, pixelSize);
+            } else if (nextDueNs < 0 || dueNs < nextDueNs) {
+                nextDueNs = dueNs;
+            }
+        }
+
+        if (!tile->fbo)
+            continue;
+
+        // Rendered for the default framebuffer already, so a plain copy into place
+        const int x = static_cast<int>(tile->rect.x() * dpr);
+        const int y = targetHeight - static_cast<int>(tile->rect.y() * dpr) - tile->fbo->height();
+        gl->glBindFramebuffer(GL_READ_FRAMEBUFFER, tile->fbo->handle());
+        gl->glBindFramebuffer(GL_DRAW_FRAMEBUFFER, defaultFramebufferObject());
+        gl->glBlitFramebuffer(0, 0, tile->fbo->width(), tile->fbo->height(),
+                              x, y, x + tile->fbo->width(), y + tile->fbo->height(),
+                              GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    }
+    gl->glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebufferObject());
+
+    if (nextDueNs >= 0)
+        throttleTimer->start(static_cast<int>((nextDueNs - now) / 1000000) + 1);
+}
+
+void VideoWall::updateVisibility()
+{
+    // Qt clips to parent widgets and scroll areas but knows nothing of other
+    // windows covering this one; the screen edge it can be told about
+    QRegion visible = window()->isMinimized() || !isVisible() ? QRegion() : visibleRegion();
+    if (screen()) {
+        const QRect desktop = screen()->virtualGeometry();
+        visible &= QRect(mapFromGlobal(desktop.topLeft()), desktop.size());
+    }
+
+    for (auto &tile : tiles) {
+        tile->visible = visible.intersects(tile->rect);
+
+        // Not rendering a tile saves little while it still decodes; hidden
+        // tiles are paused and pick up where they were when shown again
+        if (!tile->mpv || tile->paused == !tile->visible)
+            continue;
+        tile->paused = !tile->visible;
+        int pause = tile->paused ? 1 : 0;
+        mpv_set_property_async(tile->mpv, 0, "pause", MPV_FORMAT_FLAG, &pause);
+    }
+}
+
+void VideoWall::renderTile(Tile &tile, const QSize &pixelSize)
+{
+    const bool resized = !tile.fbo || tile.fbo->size() != pixelSize;
+    const bool newFrame = mpv_render_context_update(tile.renderContext) & MPV_RENDER_UPDATE_FRAME;
+    if (!newFrame && !resized)
+        return;
+
+    if (resized) {
+        delete tile.fbo;
+        tile.fbo = new QOpenGLFramebufferObject(pixelSize);
+    }
+
+    mpv_opengl_fbo target = {
+        .fbo = static_cast<int>(tile.fbo->handle()),
+        .w   = pixelSize.width(),
+        .h   = pixelSize.height(),
+        .internal_format = 0,
+    };
+
+    int flip_y = 1;
+    // Never wait for a tile's display time: the other tiles are queued behind it
+    int block = 0;
+
+    mpv_render_param params[] = {
+        {MPV_RENDER_PARAM_OPENGL_FBO, &target},
+        {MPV_RENDER_PARAM_FLIP_Y, &flip_y},
+        {MPV_RENDER_PARAM_BLOCK_FOR_TARGET_TIME, &block},
+        {MPV_RENDER_PARAM_INVALID, nullptr}
+    };
+
+    mpv_render_context_render(tile.renderContext, params);
+    tile.lastRenderNs = clock.nsecsElapsed();
+    tile.swapPending = true;
+    ++tile.framesRendered;
+}
+
+void VideoWall::reportSwaps()
+{
+    for (auto &tile : tiles) {
+        if (tile->swapPending && tile->renderContext) {
+            tile->swapPending = false;
+            mpv_render_context_report_swap(tile->renderContext);
+        }
+    }
+}
+
+QList<VideoWall::TileStats> VideoWall::tileStats() const
+{
+    QList<TileStats> stats;
+    for (const auto &tile : tiles) {
+        TileStats s;
+        s.url = tile->url;
+        s.playing = tile->renderContext != nullptr;
+        s.visible = tile->visible;
+        s.decodeThreads = tile->decodeThreads;
+        s.framesRendered = tile->framesRendered;
+        stats << s;
+    }
+    return stats;
+}
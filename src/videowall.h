@@ -0,0 +1,113 @@
+#pragma once
+#include <QElapsedTimer>
+#include <QList>
+#include <QOpenGLWidget>
+#include <QRect>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <vector>
+#include <mpv/client.h>
+#include <mpv/render_gl.h>
+
+class QOpenGLFramebufferObject;
+
+// Grid of streams in one window. Every tile is its own mpv core, but all of
+// them render through this widget's single GL context: mpv's callbacks only
+// mark a tile dirty, and one repaint renders the dirty tiles into their FBOs
+// and blits every tile into place. Tiles outside the visible part of the
+// widget (minimized, clipped by a scroll area or parent, or pushed off the
+// screen) are paused and rendered at most at kHiddenFps. Occlusion by other
+// windows is not known to Qt, so a covered wall still plays every tile.
+// Decoder threads are split between the tiles instead of each core sizing
+// itself for the whole machine.
+class VideoWall : public QOpenGLWidget
+{
+    Q_OBJECT
+
+public:
+    explicit VideoWall(QWidget *parent = nullptr);
+    ~VideoWall() override;
+
+    // Replaces all tiles; cores start in the background and play when ready
+    void setSources(const QStringList &urls);
+    int tileCount() const { return static_cast<int>(tiles.size()); }
+
+    // Decoder threads shared out among the tiles (default: one per CPU).
+    // Applies to tiles created afterwards.
+    void setDecodeThreadBudget(int threads) { threadBudget = qMax(1, threads); }
+
+    struct TileStats
+    {
+        QString url;
+        bool playing = false;     // core up and render context attached
+        bool visible = false;     // playing and rendered at full rate
+        int decodeThreads = 0;
+        quint64 framesRendered = 0;
+    };
+    QList<TileStats> tileStats() const;
+
+signals:
+    // Every tile has a core and a render context (or failed to get one)
+    void ready();
+
+protected:
+    void initializeGL() override;
+    void resizeGL(int width, int height) override;
+    void paintGL() override;
+
+private slots:
+    void adoptCores();
+    void processEvents();
+    void reportSwaps();
+
+private:
+    struct Tile
+    {
+        VideoWall *wall = nullptr;
+        QString url;
+        int decodeThreads = 1;
+        std::future<mpv_handle *> coreFuture;
+        mpv_handle *mpv = nullptr;
+        mpv_render_context *renderContext = nullptr;
+        QOpenGLFramebufferObject *fbo = nullptr;
+        QRect rect;                       // logical pixels in the widget
+        std::atomic<bool> dirty{false};   // set from mpv's render thread
+        bool updatePending = false;
+        bool visible = true;
+        bool paused = false;              // hidden tiles do not decode
+        bool swapPending = false;
+        qint64 lastRenderNs = 0;
+        quint64 framesRendered = 0;
+    };
+
+    static mpv_handle *createTileCore(int decodeThreads);
+    static void onRenderUpdate(void *ctx);
+    static void onWakeup(void *ctx);
+
+    void clearTiles();
+    void layoutTiles();
+    void attachPending();
+    void attachRenderContext(Tile &tile);
+    void scheduleRepaint();
+    void updateVisibility();
+    void renderTile(Tile &tile, const QSize &pixelSize);
+
+    static constexpr int kHiddenFps = 2;
+    static constexpr int kVisibilityCheckMs = 500;
+    static constexpr int kTileSpacing = 2;
+
+    std::vector<std::unique_ptr<Tile>> tiles;
+    int threadBudget;
+    bool glReady = false;
+    bool readyEmitted = false;
+
+    std::atomic<bool> repaintQueued{false};
+    std::atomic<bool> eventsQueued{false};
+    QTimer *throttleTimer;
+    QTimer *visibilityTimer;
+    QElapsedTimer clock;
+};